@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    AnalyzerFifo.h
+    Wait-free single producer / single consumer sample queue from the audio
+    thread to the spectrum analyzer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// The audio thread pushes a mono mixdown of each block; the analyzer thread pulls it.
+// Storage is allocated the first time an analyzer enables the queue, and push() never
+// blocks: whatever doesn't fit while the reader is behind is dropped. Nothing is pushed
+// unless the queue is enabled, so with the editor closed the audio thread only checks a
+// flag, and an instance whose editor was never opened holds no storage at all.
+class AnalyzerFifo
+{
+public:
+    static constexpr int capacity = 1 << 14;
+
+    AnalyzerFifo() = default;
+
+    // Only the analyzer calls this. Neither the audio thread nor the reader touch the
+    // storage before they have seen it enabled, which happens after it is allocated.
+    void setEnabled(bool shouldBeEnabled)
+    {
+        if (shouldBeEnabled && buffer.empty())
+            buffer.resize((size_t) capacity);
+
+        enabled.store(shouldBeEnabled, std::memory_order_release);
+    }
+
+    bool isEnabled() const noexcept                  { return enabled.load(std::memory_order_acquire); }
+
+    // Audio thread
+    template <typename SampleType>
+    void push(const SampleType* const* channels, int numChannels, int numSamples) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+        mixDown(channels, numChannels, 0, buffer.data() + start1, size1);
+        mixDown(channels, numChannels, size1, buffer.data() + start2, size2);
+        fifo.finishedWrite(size1 + size2);
+    }
+
+    // Analyzer thread. Returns the number of samples copied into dest.
+    int pull(float* dest, int maxSamples) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+        std::copy_n(buffer.data() + start1, size1, dest);
+        std::copy_n(buffer.data() + start2, size2, dest + size1);
+        fifo.finishedRead(size1 + size2);
+        return size1 + size2;
+    }
+
+private:
+    template <typename SampleType>
+    static void mixDown(const SampleType* const* channels, int numChannels, int offset, float* dest, int numSamples) noexcept
+    {
+        if (numSamples <= 0)
+            return;
+
+        const auto gain = 1.f / (float) numChannels;
+
+        if constexpr (std::is_same<SampleType, float>::value)
+        {
+            juce::FloatVectorOperations::copyWithMultiply(dest, channels[0] + offset, gain, numSamples);
+            for (int ch = 1; ch < numChannels; ++ch)
+                juce::FloatVectorOperations::addWithMultiply(dest, channels[ch] + offset, gain, numSamples);
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] = gain * (float) channels[0][offset + i];
+            for (int ch = 1; ch < numChannels; ++ch)
+                for (int i = 0; i < numSamples; ++i)
+                    dest[i] += gain * (float) channels[ch][offset + i];
+        }
+    }
+
+    juce::AbstractFifo fifo { capacity };
+    std::vector<float> buffer;
+    std::atomic<bool> enabled { false };
+
+    JUCE_DECLARE_NON_COPYABLE (AnalyzerFifo)
+};
@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    BandDesignTable.cpp
+
+  ==============================================================================
+*/
+
+#include "BandDesignTable.h"
+
+BandDesignTable::BandDesignTable(double rate)
+    : sampleRate(rate),
+      logMinFrequency(std::log(minFrequency)),
+      logMaxFrequency(std::log(rate * 0.5)),
+      frequencyScale(frequencyIntervals / (logMaxFrequency - logMinFrequency))
+{
+    jassert(rate > 2.0 * minFrequency);
+
+    // With u = ln(f) and w = 2 pi e^u / fs: d sin(w) / du = w cos(w) and
+    // d (1 - cos(w)) / du = w sin(w). The versine is built from sin(w / 2) so it keeps
+    // its full relative precision at low frequencies, where 1 - cos(w) cancels.
+    const auto frequencyStep = 1.0 / frequencyScale;
+    sinOmega.resize(frequencyIntervals + 1);
+    versine.resize(frequencyIntervals + 1);
+    for (int i = 0; i <= frequencyIntervals; ++i)
+    {
+        const auto omega = juce::MathConstants<double>::twoPi * std::exp(logMinFrequency + i * frequencyStep) / sampleRate;
+        const auto sinHalfOmega = std::sin(0.5 * omega);
+        sinOmega[(size_t) i] = { std::sin(omega), frequencyStep * omega * std::cos(omega) };
+        versine[(size_t) i] = { 2.0 * sinHalfOmega * sinHalfOmega, frequencyStep * omega * std::sin(omega) };
+    }
+
+    // A = 10^(g / 40) = e^(k g), so dA / dg = k A
+    const auto k = std::log(10.0) / 40.0;
+    amplitude.resize(gainIntervals + 1);
+    sqrtAmplitude.resize(gainIntervals + 1);
+    for (int i = 0; i <= gainIntervals; ++i)
+    {
+        const auto gainDecibels = -maxGainDecibels + i * gainStepDecibels;
+        const auto A = std::exp(k * gainDecibels);
+        const auto sqrtA = std::exp(0.5 * k * gainDecibels);
+        amplitude[(size_t) i] = { A, gainStepDecibels * k * A };
+        sqrtAmplitude[(size_t) i] = { sqrtA, gainStepDecibels * 0.5 * k * sqrtA };
+    }
+}
+
+double BandDesignTable::interpolate(const std::vector<Knot>& knots, double position) noexcept
+{
+    const auto index = juce::jmin((int) position, (int) knots.size() - 2);
+    const auto t = position - index;
+    const auto t2 = t * t;
+    const auto t3 = t2 * t;
+    const auto& k0 = knots[(size_t) index];
+    const auto& k1 = knots[(size_t) index + 1];
+
+    return (2.0 * t3 - 3.0 * t2 + 1.0) * k0.value + (t3 - 2.0 * t2 + t) * k0.slope
+         + (3.0 * t2 - 2.0 * t3) * k1.value + (t3 - t2) * k1.slope;
+}
+
+BiquadCoefficients BandDesignTable::makeBandBiquad(const BandSettings& band) const noexcept
+{
+    if (isFlat(band))
+        return {};
+
+    const auto logFrequency = std::log((double) band.freq);
+    if (logFrequency < logMinFrequency || logFrequency > logMaxFrequency
+        || std::abs(band.gainDecibels) > maxGainDecibels)
+        return ::makeBandBiquad(sampleRate, band);
+
+    const auto frequencyPosition = (logFrequency - logMinFrequency) * frequencyScale;
+    const auto s = interpolate(sinOmega, frequencyPosition);
+    const auto c = 1.0 - interpolate(versine, frequencyPosition);
+
+    const auto gainPosition = (band.gainDecibels + maxGainDecibels) / gainStepDecibels;
+    const auto quality = (double) band.quality;
+
+    // The same expressions as the exact designers in FilterChain.cpp
+    switch (band.type)
+    {
+        case BandType_LowShelf:
+        case BandType_HighShelf:
+        {
+            const auto A = interpolate(amplitude, gainPosition);
+            const auto aminus1 = A - 1.0;
+            const auto aplus1 = A + 1.0;
+            const auto beta = s * interpolate(sqrtAmplitude, gainPosition) / quality;
+            const auto aminus1TimesCoso = aminus1 * c;
+
+            if (band.type == BandType_LowShelf)
+                return normaliseBiquad(A * (aplus1 - aminus1TimesCoso + beta),
+                                       A * 2.0 * (aminus1 - aplus1 * c),
+                                       A * (aplus1 - aminus1TimesCoso - beta),
+                                       aplus1 + aminus1TimesCoso + beta,
+                                       -2.0 * (aminus1 + aplus1 * c),
+                                       aplus1 + aminus1TimesCoso - beta);
+
+            return normaliseBiquad(A * (aplus1 + aminus1TimesCoso + beta),
+                                   A * -2.0 * (aminus1 + aplus1 * c),
+                                   A * (aplus1 + aminus1TimesCoso - beta),
+                                   aplus1 - aminus1TimesCoso + beta,
+                                   2.0 * (aminus1 - aplus1 * c),
+                                   aplus1 - aminus1TimesCoso - beta);
+        }
+
+        case BandType_Notch:
+        {
+            // cot(w / 2) = sin(w) / (1 - cos(w))
+            const auto n = s / (1.0 - c);
+            const auto nSquared = n * n;
+            const auto invQ = 1.0 / quality;
+
+            return normaliseBiquad(nSquared + 1.0, 2.0 * (1.0 - nSquared), nSquared + 1.0,
+                                   1.0 + n * invQ + nSquared, 2.0 * (1.0 - nSquared), 1.0 - n * invQ + nSquared);
+        }
+
+        case BandType_Peak:
+        default:
+        {
+            const auto A = interpolate(amplitude, gainPosition);
+            const auto alpha = s / (quality * 2.0);
+            const auto c2 = -2.0 * c;
+            const auto alphaTimesA = alpha * A;
+            const auto alphaOverA = alpha / A;
+
+            return normaliseBiquad(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA, 1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+        }
+    }
+}
+
+std::shared_ptr<const BandDesignTable> BandDesignTable::getShared(double sampleRate)
+{
+    static juce::CriticalSection lock;
+    static std::vector<std::weak_ptr<const BandDesignTable>> tables;
+
+    const juce::ScopedLock sl(lock);
+
+    tables.erase(std::remove_if(tables.begin(), tables.end(), [](const auto& t) { return t.expired(); }), tables.end());
+
+    for (const auto& t : tables)
+        if (auto table = t.lock())
+            if (table->getSampleRate() == sampleRate)
+                return table;
+
+    auto table = std::make_shared<const BandDesignTable>(sampleRate);
+    tables.push_back(table);
+    return table;
+}
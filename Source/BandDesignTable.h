@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    BandDesignTable.h
+    Table-driven designer for the parametric bands, used to redesign moving
+    bands on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterChain.h"
+
+// Every RBJ band shape needs only sin(w), cos(w) and the gain terms A = 10^(g/40) and
+// sqrt(A). Those are tabulated with their exact derivatives and read back with cubic
+// Hermite interpolation: the trig terms on a grid over log frequency, the gain terms on
+// a grid over dB. What is left per design is a log, a handful of multiplies and one
+// division.
+//
+// With the grid spacings below the interpolation error of every tabulated term stays
+// around 1e-9, and the resulting coefficients stay within maxCoefficientError of
+// makeBandBiquad() (the worst case, a +24 dB shelf just under Nyquist, is about 2.5e-8).
+// The benchmark tool's --check-design mode verifies that across the
+// full parameter range. Anything outside the tabulated range (frequencies under 10 Hz,
+// gains beyond +/-24 dB) falls back to the exact designer.
+//
+// A table only depends on the sample rate, so tables are built in prepareToPlay and
+// shared between all instances running at the same rate.
+class BandDesignTable
+{
+public:
+    static constexpr double maxCoefficientError = 1.0e-7;
+
+    explicit BandDesignTable(double sampleRate);
+
+    double getSampleRate() const noexcept   { return sampleRate; }
+
+    // Allocation-free and lock-free; same result as makeBandBiquad() within the bound above
+    BiquadCoefficients makeBandBiquad(const BandSettings& band) const noexcept;
+
+    // The table for the given rate, built on first use and shared for as long as anyone
+    // holds on to it. Locks and may allocate, so keep it off the audio thread.
+    static std::shared_ptr<const BandDesignTable> getShared(double sampleRate);
+
+private:
+    static constexpr double minFrequency = 10.0;
+    static constexpr int frequencyIntervals = 1024;
+    static constexpr double maxGainDecibels = 24.0;
+    static constexpr double gainStepDecibels = 0.25;
+    static constexpr int gainIntervals = (int) (2 * maxGainDecibels / gainStepDecibels);
+
+    // A value and its derivative times the grid spacing at one grid point
+    struct Knot
+    {
+        double value, slope;
+    };
+
+    static double interpolate(const std::vector<Knot>& knots, double position) noexcept;
+
+    double sampleRate;
+    double logMinFrequency, logMaxFrequency, frequencyScale;
+    std::vector<Knot> sinOmega, versine;     // sin(w) and 1 - cos(w)
+    std::vector<Knot> amplitude, sqrtAmplitude;
+};
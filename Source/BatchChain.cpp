@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    BatchChain.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchChain.h"
+
+template <typename SampleType>
+BatchChain<SampleType>::BatchChain()
+{
+    const BiquadCoefficients identity;
+    for (int slot = 0; slot < numSlots; ++slot)
+        setSlot(slot, identity, false);
+
+    updateActiveSlots();
+    reset();
+}
+
+template <typename SampleType>
+void BatchChain<SampleType>::reset() noexcept
+{
+    state.s1.fill(Vector::expand(SampleType()));
+    state.s2.fill(Vector::expand(SampleType()));
+}
+
+template <typename SampleType>
+void BatchChain<SampleType>::copyFrom(const BatchChain& other) noexcept
+{
+    coefficients = other.coefficients;
+    state = other.state;
+    slotIsActive = other.slotIsActive;
+    activeSlots = other.activeSlots;
+    numActiveSlots = other.numActiveSlots;
+}
+
+template <typename SampleType>
+void BatchChain<SampleType>::setSlot(int slot, const BiquadCoefficients& c, bool isActive) noexcept
+{
+    const auto index = (size_t) slot;
+    coefficients.b0[index] = Vector::expand(static_cast<SampleType>(c.b0));
+    coefficients.b1[index] = Vector::expand(static_cast<SampleType>(c.b1));
+    coefficients.b2[index] = Vector::expand(static_cast<SampleType>(c.b2));
+    coefficients.a1[index] = Vector::expand(static_cast<SampleType>(c.a1));
+    coefficients.a2[index] = Vector::expand(static_cast<SampleType>(c.a2));
+
+    // A slot that was switched off holds stale state from whenever it last ran
+    if (isActive && ! slotIsActive[index])
+    {
+        state.s1[index] = Vector::expand(SampleType());
+        state.s2[index] = Vector::expand(SampleType());
+    }
+
+    slotIsActive[index] = isActive;
+}
+
+template <typename SampleType>
+void BatchChain<SampleType>::updateActiveSlots() noexcept
+{
+    numActiveSlots = 0;
+    for (int slot = 0; slot < numSlots; ++slot)
+        if (slotIsActive[(size_t) slot])
+            activeSlots[(size_t) numActiveSlots++] = slot;
+}
+
+template <typename SampleType>
+void BatchChain<SampleType>::setCutSections(int firstSlot, const std::array<BiquadCoefficients, 4>& sections, Slope slope) noexcept
+{
+    const auto numActive = numSections(slope);
+    for (int i = 0; i < maxCutSections; ++i)
+        setSlot(firstSlot + i, sections[(size_t) i], i < numActive);
+
+    updateActiveSlots();
+}
+
+template <typename SampleType>
+void BatchChain<SampleType>::setLowCut(const std::array<BiquadCoefficients, 4>& sections, Slope slope) noexcept
+{
+    setCutSections(0, sections, slope);
+}
+
+template <typename SampleType>
+void BatchChain<SampleType>::setBand(int band, const BiquadCoefficients& section) noexcept
+{
+    jassert(band >= 0 && band < maxBands);
+    const auto slot = firstBandSlot + band;
+    const auto wasActive = slotIsActive[(size_t) slot];
+
+    // Identity sections, i.e. disabled or flat bands, leave the signal untouched and keep
+    // their state at zero, so skipping them changes nothing
+    const auto isActive = ! isIdentity(section);
+    setSlot(slot, section, isActive);
+
+    if (isActive != wasActive)
+        updateActiveSlots();
+}
+
+template <typename SampleType>
+void BatchChain<SampleType>::setHighCut(const std::array<BiquadCoefficients, 4>& sections, Slope slope) noexcept
+{
+    setCutSections(firstHighCutSlot, sections, slope);
+}
+
+template <typename SampleType>
+void BatchChain<SampleType>::processSlot(int slot, SampleType* data, int numSamples) noexcept
+{
+    const auto index = (size_t) slot;
+    const auto b0 = coefficients.b0[index], b1 = coefficients.b1[index], b2 = coefficients.b2[index];
+    const auto a1 = coefficients.a1[index], a2 = coefficients.a2[index];
+    auto s1 = state.s1[index], s2 = state.s2[index];
+
+    for (int i = 0; i < numSamples; ++i, data += numLanes)
+    {
+        const auto x = Vector::fromRawArray(data);
+        const auto y = b0 * x + s1;
+        s1 = b1 * x - a1 * y + s2;
+        s2 = b2 * x - a2 * y;
+        y.copyToRawArray(data);
+    }
+
+    state.s1[index] = s1;
+    state.s2[index] = s2;
+}
+
+template <typename SampleType>
+void BatchChain<SampleType>::process(SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert(numChannels <= numLanes);
+    jassert(numSamples <= maxBlockSize);
+
+    // Interleave so that each sample of every channel sits in its own lane; unused lanes
+    // run on silence.
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto* frame = interleaved + i * numLanes;
+        int ch = 0;
+        for (; ch < numChannels; ++ch)
+            frame[ch] = channels[ch][i];
+        for (; ch < numLanes; ++ch)
+            frame[ch] = SampleType();
+    }
+
+    for (int n = 0; n < numActiveSlots; ++n)
+        processSlot(activeSlots[(size_t) n], interleaved, numSamples);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto* frame = interleaved + i * numLanes;
+        for (int ch = 0; ch < numChannels; ++ch)
+            channels[ch][i] = frame[ch];
+    }
+}
+
+template class BatchChain<float>;
+template class BatchChain<double>;
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    BatchChain.h
+    Runs the low cut, parametric and high cut sections of a chain over a batch
+    of channels at once, one channel per SIMD lane.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterChain.h"
+#include "ChainSmoother.h"
+
+// All lanes share one coefficient set, which is what the processor's channels always
+// use anyway, so a stereo pair costs the same instructions as a single channel. The
+// lane count follows the native register width for SampleType, e.g. four floats or two
+// doubles with SSE, twice that with AVX.
+//
+// Coefficients and state are kept as a structure of arrays with one slot per section:
+// low cut sections, then the parametric bands, then the high cut sections. Only the
+// slots that do something are listed as active, so sections beyond the current slopes
+// and bands that are disabled (or flat, which designs to the same identity section)
+// cost nothing. Each active section then runs over the whole block in one tight loop
+// with its coefficients and state held in registers.
+template <typename SampleType>
+class BatchChain
+{
+public:
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int numLanes = (int) Vector::SIMDNumElements;
+    static constexpr int maxBlockSize = ChainSmoother::subBlockSize;
+
+    BatchChain();
+
+    void reset() noexcept;
+
+    // Takes over another chain's coefficients and state, so the copy carries on exactly
+    // where the original is
+    void copyFrom(const BatchChain& other) noexcept;
+
+    void setLowCut(const std::array<BiquadCoefficients, 4>& sections, Slope slope) noexcept;
+    void setBand(int band, const BiquadCoefficients& section) noexcept;
+    void setHighCut(const std::array<BiquadCoefficients, 4>& sections, Slope slope) noexcept;
+
+    // Filters numChannels (at most numLanes) channels in place. numSamples must not
+    // exceed maxBlockSize; the processor already works on sub-blocks of that size.
+    void process(SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+private:
+    static constexpr int maxCutSections = 4;
+    static constexpr int firstBandSlot = maxCutSections;
+    static constexpr int firstHighCutSlot = maxCutSections + maxBands;
+    static constexpr int numSlots = 2 * maxCutSections + maxBands;
+
+    static int numSections(Slope slope) noexcept   { return static_cast<int>(slope) + 1; }
+    void setSlot(int slot, const BiquadCoefficients& coefficients, bool isActive) noexcept;
+    void setCutSections(int firstSlot, const std::array<BiquadCoefficients, 4>&, Slope) noexcept;
+    void updateActiveSlots() noexcept;
+
+    // Transposed direct form II, the same structure juce::dsp::IIR::Filter uses
+    void processSlot(int slot, SampleType* interleaved, int numSamples) noexcept;
+
+    struct Coefficients
+    {
+        alignas (64) std::array<Vector, numSlots> b0, b1, b2, a1, a2;
+    };
+
+    struct State
+    {
+        alignas (64) std::array<Vector, numSlots> s1, s2;
+    };
+
+    Coefficients coefficients;
+    State state;
+    std::array<bool, numSlots> slotIsActive {};
+    std::array<int, numSlots> activeSlots {};
+    int numActiveSlots { 0 };
+
+    alignas (Vector::SIMDRegisterSize) SampleType interleaved[maxBlockSize * numLanes];
+
+    JUCE_DECLARE_NON_COPYABLE (BatchChain)
+};
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    BinaryState.cpp
+
+  ==============================================================================
+*/
+
+#include "BinaryState.h"
+
+namespace
+{
+    constexpr juce::uint32 fnvOffsetBasis = 2166136261u, fnvPrime = 16777619u;
+
+    juce::uint32 fnv1a(const void* data, size_t size, juce::uint32 hash = fnvOffsetBasis) noexcept
+    {
+        const auto* bytes = static_cast<const juce::uint8*>(data);
+        for (size_t i = 0; i < size; ++i)
+            hash = (hash ^ bytes[i]) * fnvPrime;
+        return hash;
+    }
+
+    float readFloat(const char* bytes) noexcept
+    {
+        const auto bits = juce::ByteOrder::littleEndianInt(bytes);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    int getStateSize(int numValues) noexcept
+    {
+        return 12 + 4 * numValues + 4;
+    }
+
+    float getPlainValue(const juce::AudioProcessorParameter& parameter) noexcept
+    {
+        if (auto* ranged = dynamic_cast<const juce::RangedAudioParameter*>(&parameter))
+            return ranged->convertFrom0to1(ranged->getValue());
+        return parameter.getValue();
+    }
+
+    float toNormalised(const juce::AudioProcessorParameter& parameter, float value) noexcept
+    {
+        if (auto* ranged = dynamic_cast<const juce::RangedAudioParameter*>(&parameter))
+            return ranged->convertTo0to1(value);
+        return juce::jlimit(0.f, 1.f, value);
+    }
+}
+
+juce::uint32 BinaryState::hashLayout(const juce::Array<juce::AudioProcessorParameter*>& parameters, int numValues)
+{
+    auto hash = fnvOffsetBasis;
+    for (int i = 0; i < numValues; ++i)
+    {
+        const auto* withID = dynamic_cast<const juce::AudioProcessorParameterWithID*>(parameters[i]);
+        const auto id = withID != nullptr ? withID->paramID : juce::String(i);
+
+        // The terminator keeps "ab" + "c" and "a" + "bc" apart
+        hash = fnv1a(id.toRawUTF8(), id.getNumBytesAsUTF8() + 1, hash);
+    }
+    return hash;
+}
+
+bool BinaryState::isBinaryState(const void* data, int sizeInBytes) noexcept
+{
+    return data != nullptr && sizeInBytes >= (int) sizeof(Header)
+        && juce::ByteOrder::littleEndianInt(data) == magic;
+}
+
+int BinaryState::getSize(const void* data, int sizeInBytes) noexcept
+{
+    if (! isBinaryState(data, sizeInBytes))
+        return 0;
+
+    const auto numValues = (int) juce::ByteOrder::littleEndianShort(static_cast<const char*>(data) + 6);
+    return juce::jmin(sizeInBytes, getStateSize(numValues));
+}
+
+void BinaryState::write(const juce::Array<juce::AudioProcessorParameter*>& parameters, juce::MemoryBlock& dest)
+{
+    const auto numValues = parameters.size();
+    jassert(numValues <= 0xffff);
+
+    dest.setSize((size_t) getStateSize(numValues));
+    juce::MemoryOutputStream out(dest, false);
+
+    out.writeInt((int) magic);
+    out.writeShort((short) currentVersion);
+    out.writeShort((short) numValues);
+    out.writeInt((int) hashLayout(parameters, numValues));
+
+    for (const auto* parameter : parameters)
+        out.writeFloat(getPlainValue(*parameter));
+
+    out.writeInt((int) fnv1a(dest.getData(), out.getPosition()));
+    jassert((int) out.getPosition() == getStateSize(numValues));
+}
+
+bool BinaryState::read(const void* data, int sizeInBytes, const juce::Array<juce::AudioProcessorParameter*>& parameters)
+{
+    if (! isBinaryState(data, sizeInBytes))
+        return false;
+
+    const auto* bytes = static_cast<const char*>(data);
+    const auto version = juce::ByteOrder::littleEndianShort(bytes + 4);
+    const auto numValues = (int) juce::ByteOrder::littleEndianShort(bytes + 6);
+    const auto layoutHash = juce::ByteOrder::littleEndianInt(bytes + 8);
+
+    // A newer layout can hold parameters this build doesn't know where to put
+    if (version == 0 || version > currentVersion || numValues > parameters.size()
+        || sizeInBytes != getStateSize(numValues)
+        || juce::ByteOrder::littleEndianInt(bytes + sizeInBytes - 4) != fnv1a(bytes, (size_t) sizeInBytes - 4)
+        || layoutHash != hashLayout(parameters, numValues))
+        return false;
+
+    const auto* values = bytes + sizeof(Header);
+    for (int i = 0; i < numValues; ++i)
+        if (! std::isfinite(readFloat(values + 4 * i)))
+            return false;
+
+    // Parameters added since the blob was written go back to their defaults, so an old
+    // preset sounds the same whatever this instance was set to before
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        auto* parameter = parameters[i];
+        const auto normalised = i < numValues ? toNormalised(*parameter, readFloat(values + 4 * i))
+                                              : parameter->getDefaultValue();
+        if (normalised != parameter->getValue())
+            parameter->setValueNotifyingHost(normalised);
+    }
+
+    return true;
+}
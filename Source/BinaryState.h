@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    BinaryState.h
+    Compact, fixed layout plugin state: one plain value per parameter, in the
+    order the parameter layout creates them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Layout, all little endian:
+//
+//   uint32  magic           "FEQS"
+//   uint16  version
+//   uint16  numValues
+//   uint32  layoutHash      FNV-1a of the first numValues parameter IDs
+//   float32 values[numValues]
+//   uint32  checksum        FNV-1a of everything before it
+//
+// Values are stored denormalised, so a parameter whose range grows later still restores
+// to the same setting. New parameters only ever go at the end of the layout; a blob with
+// fewer values than the processor has parameters sets the rest to their defaults, and the
+// layout hash rejects one written for a different order.
+//
+// A ValueTree stream starts with the tree's type name, so the magic tells the two
+// formats apart and the old blobs keep loading through replaceState().
+class BinaryState
+{
+public:
+    static constexpr juce::uint32 magic = 0x53514546;   // "FEQS"
+    static constexpr juce::uint16 currentVersion = 1;
+
+    static bool isBinaryState(const void* data, int sizeInBytes) noexcept;
+
+    // The number of bytes the blob at the start of data takes up, going by its header, so
+    // whatever the processor stores after it can be found. Never more than sizeInBytes,
+    // and 0 if data doesn't start with a blob.
+    static int getSize(const void* data, int sizeInBytes) noexcept;
+
+    static void write(const juce::Array<juce::AudioProcessorParameter*>& parameters, juce::MemoryBlock& dest);
+
+    // Checks the whole blob before touching any parameter, so a damaged one changes
+    // nothing. Only parameters whose value actually differs are set, each through
+    // setValueNotifyingHost(), which is what the processor's listeners pick up. Returns
+    // false if the blob was rejected.
+    static bool read(const void* data, int sizeInBytes, const juce::Array<juce::AudioProcessorParameter*>& parameters);
+
+private:
+    struct Header
+    {
+        juce::uint32 magic;
+        juce::uint16 version, numValues;
+        juce::uint32 layoutHash;
+    };
+
+    static_assert(sizeof(Header) == 12, "The header is read and written as raw bytes");
+
+    static juce::uint32 hashLayout(const juce::Array<juce::AudioProcessorParameter*>& parameters, int numValues);
+};
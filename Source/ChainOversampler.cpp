@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    ChainOversampler.cpp
+
+  ==============================================================================
+*/
+
+#include "ChainOversampler.h"
+
+template <typename SampleType>
+int ChainOversampler<SampleType>::getIndex(int factor, bool linearPhase) noexcept
+{
+    jassert(factor == 2 || factor == 4);
+    return (factor == 4 ? 1 : 0) + (linearPhase ? 2 : 0);
+}
+
+template <typename SampleType>
+void ChainOversampler<SampleType>::prepare(int numChannels, int channelsPerGroup, int maxBlockSize)
+{
+    activeIndex = -1;
+    const auto numGroups = (numChannels + channelsPerGroup - 1) / channelsPerGroup;
+
+    for (auto factor : { 2, 4 })
+    {
+        for (auto linearPhase : { false, true })
+        {
+            const auto type = linearPhase ? Oversampling::filterHalfBandFIREquiripple
+                                          : Oversampling::filterHalfBandPolyphaseIIR;
+            const auto stages = factor == 4 ? 2 : 1;
+
+            auto& variant = variants[(size_t) getIndex(factor, linearPhase)];
+            variant.clear();
+            for (int group = 0; group < numGroups; ++group)
+            {
+                const auto numInGroup = juce::jmin(channelsPerGroup, numChannels - group * channelsPerGroup);
+                variant.push_back(std::make_unique<Oversampling>((size_t) numInGroup, (size_t) stages, type, true));
+                variant.back()->initProcessing((size_t) maxBlockSize);
+            }
+        }
+    }
+}
+
+template <typename SampleType>
+void ChainOversampler<SampleType>::release()
+{
+    activeIndex = -1;
+    for (auto& variant : variants)
+        variant.clear();
+}
+
+template <typename SampleType>
+void ChainOversampler<SampleType>::setMode(int factor, bool linearPhase) noexcept
+{
+    const auto newIndex = (factor > 1 && isPrepared()) ? getIndex(factor, linearPhase) : -1;
+    if (newIndex == activeIndex)
+        return;
+
+    // The newly selected stages may still hold samples from the last time they ran
+    if (newIndex >= 0)
+        for (auto& stages : variants[(size_t) newIndex])
+            stages->reset();
+
+    activeIndex = newIndex;
+}
+
+template <typename SampleType>
+juce::dsp::AudioBlock<SampleType> ChainOversampler<SampleType>::processSamplesUp(const juce::dsp::AudioBlock<const SampleType>& block, int group) noexcept
+{
+    jassert(isActive());
+    return variants[(size_t) activeIndex][(size_t) group]->processSamplesUp(block);
+}
+
+template <typename SampleType>
+void ChainOversampler<SampleType>::processSamplesDown(juce::dsp::AudioBlock<SampleType>& block, int group) noexcept
+{
+    jassert(isActive());
+    variants[(size_t) activeIndex][(size_t) group]->processSamplesDown(block);
+}
+
+template <typename SampleType>
+int ChainOversampler<SampleType>::getLatencySamples(int factor, bool linearPhase) const
+{
+    if (factor <= 1 || ! isPrepared())
+        return 0;
+
+    return juce::roundToInt(variants[(size_t) getIndex(factor, linearPhase)].front()->getLatencyInSamples());
+}
+
+template class ChainOversampler<float>;
+template class ChainOversampler<double>;
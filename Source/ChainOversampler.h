@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    ChainOversampler.h
+    Optional 2x / 4x oversampling around the filter cascade.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Every variant (2x and 4x, polyphase IIR and equiripple FIR half-band stages) is built
+// in prepare(), so switching between them on the audio thread is just an index change
+// plus a state reset. With oversampling off nothing here costs anything.
+//
+// The channels are split into groups, each with stages of its own, so the processor can
+// run each group of channels through the whole chain on a different thread.
+template <typename SampleType>
+class ChainOversampler
+{
+public:
+    static constexpr int maxFactor = 4;
+
+    void prepare(int numChannels, int channelsPerGroup, int maxBlockSize);
+    void release();
+
+    // Audio thread. A factor of 1 turns oversampling off.
+    void setMode(int factor, bool linearPhase) noexcept;
+    bool isActive() const noexcept    { return activeIndex >= 0; }
+
+    // The block holds just the group's channels
+    juce::dsp::AudioBlock<SampleType> processSamplesUp(const juce::dsp::AudioBlock<const SampleType>& block, int group) noexcept;
+    void processSamplesDown(juce::dsp::AudioBlock<SampleType>& block, int group) noexcept;
+
+    // Latency the given mode adds, rounded to whole samples at the host rate.
+    int getLatencySamples(int factor, bool linearPhase) const;
+
+    bool isPrepared() const noexcept  { return ! variants[0].empty(); }
+
+private:
+    using Oversampling = juce::dsp::Oversampling<SampleType>;
+
+    static int getIndex(int factor, bool linearPhase) noexcept;
+
+    // One set of stages per channel group for each variant
+    std::array<std::vector<std::unique_ptr<Oversampling>>, 4> variants;
+    int activeIndex { -1 };
+};
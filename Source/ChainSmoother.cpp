@@ -0,0 +1,198 @@
+/*
+  ==============================================================================
+
+    ChainSmoother.cpp
+
+  ==============================================================================
+*/
+
+#include "ChainSmoother.h"
+
+void ChainSmoother::BandRamp::reset(double sampleRate)
+{
+    freq.reset(sampleRate, rampLengthSeconds);
+    quality.reset(sampleRate, rampLengthSeconds);
+    gain.reset(sampleRate, rampLengthSeconds);
+}
+
+void ChainSmoother::BandRamp::setCurrentAndTargetValue(const BandSettings& band)
+{
+    freq.setCurrentAndTargetValue(band.freq);
+    quality.setCurrentAndTargetValue(band.quality);
+    gain.setCurrentAndTargetValue(band.gainDecibels);
+}
+
+void ChainSmoother::BandRamp::setTargetValue(const BandSettings& band)
+{
+    freq.setTargetValue(band.freq);
+    quality.setTargetValue(band.quality);
+    gain.setTargetValue(band.gainDecibels);
+}
+
+bool ChainSmoother::BandRamp::isSmoothing() const noexcept
+{
+    return freq.isSmoothing() || quality.isSmoothing() || gain.isSmoothing();
+}
+
+//==============================================================================
+void ChainSmoother::prepare(double sampleRate)
+{
+    current = {};
+    current.sampleRate = sampleRate;
+
+    lowCutFreq.reset(sampleRate, rampLengthSeconds);
+    highCutFreq.reset(sampleRate, rampLengthSeconds);
+    for (auto& ramp : bandRamps)
+        ramp.reset(sampleRate);
+
+    lowCutRevision = highCutRevision = 0;
+    bandRevisions.fill(0);
+    pendingBands = pendingSwitchedBands = switchedBands = 0;
+    snapToTarget = true;
+
+    for (size_t i = 0; i < designTables.size(); ++i)
+        designTables[i] = BandDesignTable::getShared(sampleRate * (1 << i));
+    designTable = nullptr;
+}
+
+const BandDesignTable* ChainSmoother::findDesignTable(double sampleRate) const noexcept
+{
+    for (const auto& table : designTables)
+        if (table != nullptr && table->getSampleRate() == sampleRate)
+            return table.get();
+    return nullptr;
+}
+
+void ChainSmoother::setTarget(const ChainCoefficients& target)
+{
+    const auto& settings = target.settings;
+
+    // Ramping across a change of oversampling rate makes no sense, the old coefficients
+    // don't even describe the same filters any more
+    if (snapToTarget || target.sampleRate != current.sampleRate)
+    {
+        lowCutFreq.setCurrentAndTargetValue(settings.lowCutFreq);
+        highCutFreq.setCurrentAndTargetValue(settings.highCutFreq);
+        for (size_t i = 0; i < bandRamps.size(); ++i)
+            bandRamps[i].setCurrentAndTargetValue(settings.bands[i]);
+
+        current = target;
+        designTable = findDesignTable(current.sampleRate);
+        pendingBands = AllBands;
+        pendingSwitchedBands = 0;
+        snapToTarget = false;
+    }
+    else
+    {
+        if (target.lowCutRevision != lowCutRevision)
+        {
+            if (settings.lowCutSlope != current.settings.lowCutSlope)
+                pendingSwitchedBands |= LowCutBand;
+
+            lowCutFreq.setTargetValue(settings.lowCutFreq);
+            if (! lowCutFreq.isSmoothing())
+            {
+                current.lowCut = target.lowCut;
+                current.settings.lowCutFreq = settings.lowCutFreq;
+                current.settings.lowCutSlope = settings.lowCutSlope;
+                pendingBands |= LowCutBand;
+            }
+        }
+
+        if (target.highCutRevision != highCutRevision)
+        {
+            if (settings.highCutSlope != current.settings.highCutSlope)
+                pendingSwitchedBands |= HighCutBand;
+
+            highCutFreq.setTargetValue(settings.highCutFreq);
+            if (! highCutFreq.isSmoothing())
+            {
+                current.highCut = target.highCut;
+                current.settings.highCutFreq = settings.highCutFreq;
+                current.settings.highCutSlope = settings.highCutSlope;
+                pendingBands |= HighCutBand;
+            }
+        }
+
+        for (int i = 0; i < maxBands; ++i)
+        {
+            const auto index = (size_t) i;
+            if (target.bandRevisions[index] == bandRevisions[index])
+                continue;
+
+            const auto& band = settings.bands[index];
+            const auto& active = current.settings.bands[index];
+            auto& ramp = bandRamps[index];
+
+            if (band.enabled != active.enabled || band.type != active.type)
+            {
+                ramp.setCurrentAndTargetValue(band);
+                pendingSwitchedBands |= parametricBandMask(i);
+            }
+            else if (! band.enabled)
+            {
+                // A band that is off is an identity section whatever its hidden settings,
+                // so there is nothing to ramp and nothing to redesign on the way
+                ramp.setCurrentAndTargetValue(band);
+            }
+            else
+                ramp.setTargetValue(band);
+
+            if (! ramp.isSmoothing())
+            {
+                current.bands[index] = target.bands[index];
+                current.settings.bands[index] = band;
+                pendingBands |= parametricBandMask(i);
+            }
+        }
+    }
+
+    targetSettings = settings;
+    lowCutRevision = target.lowCutRevision;
+    highCutRevision = target.highCutRevision;
+    bandRevisions = target.bandRevisions;
+}
+
+int ChainSmoother::advance()
+{
+    auto changed = pendingBands;
+    pendingBands = 0;
+    switchedBands = pendingSwitchedBands;
+    pendingSwitchedBands = 0;
+
+    // Slopes, types and on/off states are discrete, so a ramping band is always designed
+    // with the target's. The last step of each ramp lands exactly on the target value and
+    // goes through the exact designer, which reproduces the designer's coefficients bit
+    // for bit; only the steps in between use the table.
+    auto settings = targetSettings;
+
+    if (lowCutFreq.isSmoothing())
+    {
+        settings.lowCutFreq = lowCutFreq.skip(subBlockSize);
+        designLowCut(current, settings);
+        changed |= LowCutBand;
+    }
+
+    if (highCutFreq.isSmoothing())
+    {
+        settings.highCutFreq = highCutFreq.skip(subBlockSize);
+        designHighCut(current, settings);
+        changed |= HighCutBand;
+    }
+
+    for (int i = 0; i < maxBands; ++i)
+    {
+        auto& ramp = bandRamps[(size_t) i];
+        if (! ramp.isSmoothing())
+            continue;
+
+        auto& band = settings.bands[(size_t) i];
+        band.freq = ramp.freq.skip(subBlockSize);
+        band.quality = ramp.quality.skip(subBlockSize);
+        band.gainDecibels = ramp.gain.skip(subBlockSize);
+        designBand(current, settings, i, ramp.isSmoothing() ? designTable : nullptr);
+        changed |= parametricBandMask(i);
+    }
+
+    return changed;
+}
@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    ChainSmoother.h
+    Ramps the continuous chain parameters towards the designer's latest set,
+    redesigning the moving bands on a fixed sub-block grid.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BandDesignTable.h"
+
+enum ChainBands
+{
+    LowCutBand          = 1 << 0,
+    HighCutBand         = 1 << 1,
+    FirstParametricBand = 1 << 2,
+    AllBands            = (FirstParametricBand << maxBands) - 1
+};
+
+// The ChainBands bit of the parametric band with the given index
+constexpr int parametricBandMask(int band) noexcept    { return FirstParametricBand << band; }
+
+// Audio thread only. Frequencies and Q are ramped multiplicatively (i.e. linearly in the
+// log domain) and band gains linearly in dB. Coefficients are recomputed once per
+// subBlockSize samples at most, and only for the bands that are actually moving, so the
+// cost per sample is bounded regardless of the host's block size. The intermediate steps
+// of a band ramp come from the shared BandDesignTable for the chain's rate.
+class ChainSmoother
+{
+public:
+    static constexpr int subBlockSize = 32;
+    static constexpr double rampLengthSeconds = 0.05;
+
+    // Also fetches the design tables for every oversampling rate, so it may allocate
+    void prepare(double sampleRate);
+
+    // Takes over a newly published set. Bands whose frequency, gain or Q moved start
+    // ramping; anything else (slope, type and on/off changes, the first set after
+    // prepare, a new oversampling rate) is applied as is.
+    void setTarget(const ChainCoefficients& target);
+
+    // Steps the ramps by one sub-block and returns the ChainBands whose coefficients in
+    // getCurrent() changed since the previous call.
+    int advance();
+
+    const ChainCoefficients& getCurrent() const noexcept { return current; }
+
+    // The ChainBands among the last advance()'s changes that switched a slope, band type
+    // or on/off state, i.e. jumped in a way no ramp can cover
+    int getSwitchedBands() const noexcept { return switchedBands; }
+
+private:
+    struct BandRamp
+    {
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> freq, quality;
+        juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> gain;
+
+        void reset(double sampleRate);
+        void setCurrentAndTargetValue(const BandSettings&);
+        void setTargetValue(const BandSettings&);
+        bool isSmoothing() const noexcept;
+    };
+
+    const BandDesignTable* findDesignTable(double sampleRate) const noexcept;
+
+    ChainCoefficients current;
+    ChainSettings targetSettings;
+    juce::uint32 lowCutRevision { 0 }, highCutRevision { 0 };
+    std::array<juce::uint32, maxBands> bandRevisions {};
+    int pendingBands { 0 }, pendingSwitchedBands { 0 }, switchedBands { 0 };
+    bool snapToTarget { true };
+
+    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> lowCutFreq, highCutFreq;
+    std::array<BandRamp, maxBands> bandRamps;
+
+    // One per oversampling factor: 1x, 2x and 4x the host rate
+    std::array<std::shared_ptr<const BandDesignTable>, 3> designTables;
+    const BandDesignTable* designTable { nullptr };
+};
@@ -0,0 +1,295 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.cpp
+
+  ==============================================================================
+*/
+
+#include "ChannelWorkerPool.h"
+
+#if JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#elif JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+#else
+ #include <semaphore.h>
+ #include <cerrno>
+#endif
+
+namespace
+{
+    constexpr int spinsBeforeYield = 64;
+
+    constexpr juce::uint64 taskMask = 0xffff;
+    constexpr int numTasksShift = 16, generationShift = 32;
+}
+
+//==============================================================================
+// A counting semaphore straight from the OS. Posting it is an atomic increment, plus a
+// kernel wake-up only if somebody is waiting; unlike juce::WaitableEvent there is no
+// mutex the audio thread could be made to wait on.
+class ChannelWorkerPool::Semaphore
+{
+public:
+    Semaphore()
+    {
+       #if JUCE_MAC || JUCE_IOS
+        semaphore = dispatch_semaphore_create(0);
+       #elif JUCE_WINDOWS
+        semaphore = CreateSemaphoreW(nullptr, 0, std::numeric_limits<LONG>::max(), nullptr);
+       #else
+        sem_init(&semaphore, 0, 0);
+       #endif
+    }
+
+    ~Semaphore()
+    {
+       #if JUCE_MAC || JUCE_IOS
+        dispatch_release(semaphore);
+       #elif JUCE_WINDOWS
+        CloseHandle(semaphore);
+       #else
+        sem_destroy(&semaphore);
+       #endif
+    }
+
+    void post(int count) noexcept
+    {
+       #if JUCE_WINDOWS
+        if (count > 0)
+            ReleaseSemaphore(semaphore, (LONG) count, nullptr);
+       #else
+        for (int i = 0; i < count; ++i)
+        {
+           #if JUCE_MAC || JUCE_IOS
+            dispatch_semaphore_signal(semaphore);
+           #else
+            sem_post(&semaphore);
+           #endif
+        }
+       #endif
+    }
+
+    void wait() noexcept
+    {
+       #if JUCE_MAC || JUCE_IOS
+        dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+       #elif JUCE_WINDOWS
+        WaitForSingleObject(semaphore, INFINITE);
+       #else
+        while (sem_wait(&semaphore) != 0 && errno == EINTR) {}
+       #endif
+    }
+
+private:
+   #if JUCE_MAC || JUCE_IOS
+    dispatch_semaphore_t semaphore;
+   #elif JUCE_WINDOWS
+    HANDLE semaphore;
+   #else
+    sem_t semaphore;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (Semaphore)
+};
+
+//==============================================================================
+ChannelWorkerPool::Worker::Worker(ChannelWorkerPool& p, int i)
+    : juce::Thread("EQ channel worker " + juce::String(i + 1)), pool(p), index(i)
+{
+    // The audio thread waits for whatever a worker has claimed, so a worker must not be
+    // held up by anything the audio thread itself wouldn't be
+    startThread(juce::Thread::realtimeAudioPriority);
+}
+
+ChannelWorkerPool::Worker::~Worker()
+{
+    stopThread(1000);
+}
+
+void ChannelWorkerPool::Worker::run()
+{
+    // The filters' state behaves exactly as it would on the audio thread
+    juce::ScopedNoDenormals noDenormals;
+
+    // Workers start their search at different slots, so they spread over the jobs
+    const auto firstSlot = index * maxJobs / maxWorkers;
+
+    while (! threadShouldExit())
+        if (! pool.runAnyTasks(*this, firstSlot))
+            pool.park();
+}
+
+//==============================================================================
+ChannelWorkerPool::ChannelWorkerPool()
+    : semaphore(std::make_unique<Semaphore>())
+{
+}
+
+ChannelWorkerPool::~ChannelWorkerPool()
+{
+    // Every client removes its job before letting go of the pool
+    jassert(std::all_of(jobs.begin(), jobs.end(), [](const auto& job) { return job.load() == nullptr; }));
+
+    // One post per worker is enough: a worker that isn't parked yet finds its post
+    // waiting when it parks, and then sees that it should exit
+    for (auto* worker : workers)
+        worker->signalThreadShouldExit();
+    semaphore->post(workers.size());
+    workers.clear();
+}
+
+bool ChannelWorkerPool::add(Job& job)
+{
+    const juce::ScopedLock sl(lock);
+    if (workers.isEmpty())
+    {
+        // The calling thread always works as well, so leave it a core
+        const auto numWorkers = juce::jlimit(1, maxWorkers, juce::SystemStats::getNumCpus() - 1);
+        for (int i = 0; i < numWorkers; ++i)
+            workers.add(new Worker(*this, i));
+    }
+
+    if (job.slot >= 0)
+        return true;
+
+    for (int slot = 0; slot < maxJobs; ++slot)
+    {
+        if (jobs[(size_t) slot].load(std::memory_order_relaxed) == nullptr)
+        {
+            job.slot = slot;
+            jobs[(size_t) slot].store(&job, std::memory_order_release);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ChannelWorkerPool::remove(Job& job)
+{
+    const juce::ScopedLock sl(lock);
+    if (job.slot < 0)
+        return;
+
+    jobs[(size_t) job.slot].store(nullptr, std::memory_order_seq_cst);
+    for (auto* worker : workers)
+        while (worker->hazard.load(std::memory_order_seq_cst) == &job)
+            juce::Thread::yield();
+
+    job.slot = -1;
+}
+
+//==============================================================================
+bool ChannelWorkerPool::runTasks(Job& job, juce::uint64 bit) noexcept
+{
+    auto ranAny = false;
+    auto work = job.work.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        const auto numTasks = (work >> numTasksShift) & taskMask;
+        const auto next = work & taskMask;
+        if (next >= numTasks)
+            return ranAny;
+
+        // Fails, and reloads, if another thread took the task or a new submission replaced
+        // the one this word came from
+        if (! job.work.compare_exchange_weak(work, work + 1, std::memory_order_acquire, std::memory_order_acquire))
+            continue;
+
+        // Whoever claims the last task takes the job off the posted set, so workers that
+        // find nothing left park instead of looking again. This happens before the task
+        // is done, so before run() can return and post the job's next submission.
+        if (next + 1 == numTasks)
+            postedJobs.fetch_and(~bit, std::memory_order_relaxed);
+
+        job.function(job.context, (int) next);
+        job.pending.fetch_sub(1, std::memory_order_release);
+        ranAny = true;
+        ++work;
+    }
+}
+
+bool ChannelWorkerPool::runAnyTasks(Worker& worker, int firstSlot) noexcept
+{
+    const auto posted = postedJobs.load(std::memory_order_acquire);
+    if (posted == 0)
+        return false;
+
+    auto ranAny = false;
+    for (int i = 0; i < maxJobs; ++i)
+    {
+        const auto slot = (firstSlot + i) % maxJobs;
+        const auto bit = (juce::uint64) 1 << slot;
+        if ((posted & bit) == 0)
+            continue;
+
+        auto* job = jobs[(size_t) slot].load(std::memory_order_acquire);
+        if (job == nullptr)
+            continue;
+
+        // Only once the hazard is published and the job is still in its slot is it
+        // guaranteed to outlive this look
+        worker.hazard.store(job, std::memory_order_seq_cst);
+        if (jobs[(size_t) slot].load(std::memory_order_seq_cst) == job)
+            ranAny = runTasks(*job, bit) || ranAny;
+        worker.hazard.store(nullptr, std::memory_order_release);
+    }
+
+    return ranAny;
+}
+
+void ChannelWorkerPool::park() noexcept
+{
+    // Counted as parked before the last look for work, while run() posts its tasks before
+    // counting parked workers, so either this look finds the tasks or run() finds this
+    // worker and posts for it. A post that finds the worker already gone just makes its
+    // next park return at once.
+    numParked.fetch_add(1, std::memory_order_seq_cst);
+    if (postedJobs.load(std::memory_order_seq_cst) == 0)
+        semaphore->wait();
+    numParked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ChannelWorkerPool::run(Job& job, TaskFunction function, void* context, int numTasks) noexcept
+{
+    jassert(numTasks <= (int) taskMask);
+
+    if (job.slot < 0)
+    {
+        for (int task = 0; task < numTasks; ++task)
+            function(context, task);
+        return;
+    }
+
+    if (numTasks <= 0)
+        return;
+
+    job.function = function;
+    job.context = context;
+    job.pending.store(numTasks, std::memory_order_relaxed);
+
+    // Publishes the function, context and count along with the tasks
+    const auto generation = (job.work.load(std::memory_order_relaxed) >> generationShift) + 1;
+    job.work.store((generation << generationShift) | ((juce::uint64) numTasks << numTasksShift), std::memory_order_release);
+
+    const auto bit = (juce::uint64) 1 << job.slot;
+    postedJobs.fetch_or(bit, std::memory_order_seq_cst);
+
+    // This thread takes a task itself, so only the rest need waking for
+    const auto numToWake = juce::jmin(numTasks - 1, numParked.load(std::memory_order_seq_cst));
+    semaphore->post(numToWake);
+
+    runTasks(job, bit);
+
+    // Every task is claimed by now. Whatever is still pending is running on a real-time
+    // worker, one task each, so this waits no longer than running one task would take.
+    for (int spins = 0; job.pending.load(std::memory_order_acquire) != 0; ++spins)
+        if (spins >= spinsBeforeYield)
+            juce::Thread::yield();
+}
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    ChannelWorkerPool.h
+    A few worker threads, shared by every instance in the process, that take
+    channel groups off the audio thread for buses with many channels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Each client owns one Job, registered from prepareToPlay() or the message thread while
+// it wants the pool, and reused for every block in between. run() posts numTasks tasks
+// on the job, wakes parked workers to help, and the calling thread starts working
+// through the tasks itself; any worker that is awake takes tasks from whichever jobs
+// have some left, so idle workers help out busy instances. Tasks are claimed one at a
+// time through a single atomic word per job, which holds the submission's generation,
+// the number of tasks and the next task, so a worker still holding an earlier
+// submission's word can never claim a task of the next one.
+//
+// Workers are real-time threads. They park on a semaphore as soon as no job has tasks
+// left to claim, and run() posts it only for as many workers as are parked and could
+// help; a post takes no lock. The caller never waits for a worker to wake: by the time
+// it has nothing left to claim, every task has been claimed, so all it waits for is the
+// tasks already running on workers, and each of those is a single task, no longer than
+// the caller would have taken to run it itself.
+class ChannelWorkerPool
+{
+public:
+    using TaskFunction = void (*)(void* context, int task);
+
+    class Job
+    {
+    public:
+        Job() = default;
+
+    private:
+        friend class ChannelWorkerPool;
+
+        // generation << 32 | numTasks << 16 | next task
+        std::atomic<juce::uint64> work { 0 };
+        std::atomic<int> pending { 0 };
+        TaskFunction function { nullptr };
+        void* context { nullptr };
+        int slot { -1 };
+
+        JUCE_DECLARE_NON_COPYABLE (Job)
+    };
+
+    static constexpr int maxJobs = 64;
+    static constexpr int maxWorkers = 4;
+
+    ChannelWorkerPool();
+    ~ChannelWorkerPool();
+
+    // Message thread, or prepareToPlay(). The first job starts the workers. Returns false
+    // if every slot is taken, in which case the client should process serially.
+    bool add(Job& job);
+
+    // Also waits until no worker is still looking at the job, after which it may be
+    // destroyed or added again. Never call while the job is running.
+    void remove(Job& job);
+
+    // Runs function(context, task) for every task in [0, numTasks), on this thread and
+    // on whichever workers join in, and returns once they have all finished. The job
+    // must have been added. At most 0xffff tasks.
+    void run(Job& job, TaskFunction function, void* context, int numTasks) noexcept;
+
+    int getNumWorkers() const noexcept     { return workers.size(); }
+
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker(ChannelWorkerPool& pool, int index);
+        ~Worker() override;
+        void run() override;
+
+        // The job this worker is reading, so remove() knows when it is safe to return
+        std::atomic<Job*> hazard { nullptr };
+
+    private:
+        ChannelWorkerPool& pool;
+        const int index;
+    };
+
+    bool runTasks(Job& job, juce::uint64 bit) noexcept;
+    bool runAnyTasks(Worker& worker, int firstSlot) noexcept;
+    void park() noexcept;
+
+    std::array<std::atomic<Job*>, maxJobs> jobs {};
+
+    // One bit per slot whose job still has tasks to claim
+    std::atomic<juce::uint64> postedJobs { 0 };
+
+    // Parked workers wait on this; posting it never takes a lock
+    class Semaphore;
+    std::unique_ptr<Semaphore> semaphore;
+    std::atomic<int> numParked { 0 };
+
+    juce::CriticalSection lock;
+    juce::OwnedArray<Worker> workers;
+
+    JUCE_DECLARE_NON_COPYABLE (ChannelWorkerPool)
+};
@@ -0,0 +1,214 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+namespace
+{
+    juce::uint64 toBits(double value) noexcept
+    {
+        juce::uint64 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    juce::uint32 toBits(float value) noexcept
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    double fromBits(juce::uint64 bits) noexcept
+    {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void toValues(const BiquadCoefficients& c, double* values) noexcept
+    {
+        values[0] = c.b0;
+        values[1] = c.b1;
+        values[2] = c.b2;
+        values[3] = c.a1;
+        values[4] = c.a2;
+    }
+
+    BiquadCoefficients fromValues(const double* values) noexcept
+    {
+        BiquadCoefficients c;
+        c.b0 = values[0];
+        c.b1 = values[1];
+        c.b2 = values[2];
+        c.a1 = values[3];
+        c.a2 = values[4];
+        return c;
+    }
+}
+
+CoefficientCache& CoefficientCache::getInstance()
+{
+    // Never destroyed, so designers running during static destruction still find it
+    static auto* instance = new CoefficientCache();
+    return *instance;
+}
+
+//==============================================================================
+template <int NumSlots, int NumValues>
+juce::uint64 CoefficientCache::Table<NumSlots, NumValues>::hash(const Key& key) noexcept
+{
+    juce::uint64 h = 0x9e3779b97f4a7c15ull;
+    for (auto word : key)
+    {
+        h ^= word + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+        h = (h ^ (h >> 31)) * 0xbf58476d1ce4e5b9ull;
+    }
+    return h ^ (h >> 29);
+}
+
+template <int NumSlots, int NumValues>
+bool CoefficientCache::Table<NumSlots, NumValues>::find(const Key& key, double* dest) noexcept
+{
+    static_assert(juce::isPowerOfTwo(NumSlots), "Slots are picked by masking the hash");
+
+    const auto home = (int) (hash(key) & (NumSlots - 1));
+    juce::uint64 values[NumValues];
+
+    for (int probe = 0; probe < probeLength; ++probe)
+    {
+        auto& slot = slots[(size_t) ((home + probe) & (NumSlots - 1))];
+        const auto before = slot.sequence.load(std::memory_order_acquire);
+        if (before == 0 || (before & 1) != 0)
+            continue;
+
+        auto matches = true;
+        for (int i = 0; i < keyWords; ++i)
+            matches = matches && slot.key[(size_t) i].load(std::memory_order_relaxed) == key[(size_t) i];
+        if (! matches)
+            continue;
+
+        for (int i = 0; i < NumValues; ++i)
+            values[i] = slot.values[(size_t) i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before)
+            continue;
+
+        for (int i = 0; i < NumValues; ++i)
+            dest[i] = fromBits(values[i]);
+        return true;
+    }
+
+    return false;
+}
+
+template <int NumSlots, int NumValues>
+void CoefficientCache::Table<NumSlots, NumValues>::store(const Key& key, const double* values) noexcept
+{
+    const auto h = hash(key);
+    const auto home = (int) (h & (NumSlots - 1));
+
+    // A free slot if the window has one, otherwise one picked by the hash's high bits
+    auto target = (home + (int) (h >> 62)) & (NumSlots - 1);
+    for (int probe = 0; probe < probeLength; ++probe)
+    {
+        const auto index = (home + probe) & (NumSlots - 1);
+        if (slots[(size_t) index].sequence.load(std::memory_order_relaxed) == 0)
+        {
+            target = index;
+            break;
+        }
+    }
+
+    auto& slot = slots[(size_t) target];
+    auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) != 0
+        || ! slot.sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        return;
+
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (int i = 0; i < keyWords; ++i)
+        slot.key[(size_t) i].store(key[(size_t) i], std::memory_order_relaxed);
+    for (int i = 0; i < NumValues; ++i)
+        slot.values[(size_t) i].store(toBits(values[i]), std::memory_order_relaxed);
+
+    // Skips 0 on wrapping, which would read as empty
+    slot.sequence.store(sequence + 2 == 0 ? 2 : sequence + 2, std::memory_order_release);
+}
+
+//==============================================================================
+CoefficientCache::Key CoefficientCache::makeCutKey(bool highCut, float freq, Slope slope, double sampleRate) noexcept
+{
+    return { toBits(sampleRate),
+             (juce::uint64) toBits(freq),
+             ((juce::uint64) slope << 1) | (highCut ? 1u : 0u) };
+}
+
+CoefficientCache::Key CoefficientCache::makeBandKey(const BandSettings& band, double sampleRate) noexcept
+{
+    // A disabled band designs to the identity whatever its other settings
+    if (! band.enabled)
+        return { toBits(sampleRate), 0, 0 };
+
+    return { toBits(sampleRate),
+             ((juce::uint64) toBits(band.freq) << 32) | toBits(band.gainDecibels),
+             ((juce::uint64) toBits(band.quality) << 32) | ((juce::uint64) band.type << 1) | 1u };
+}
+
+bool CoefficientCache::findCut(bool highCut, float freq, Slope slope, double sampleRate,
+                               std::array<BiquadCoefficients, 4>& dest) noexcept
+{
+    double values[4 * valuesPerSection];
+    if (! cuts.find(makeCutKey(highCut, freq, slope, sampleRate), values))
+    {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    for (size_t i = 0; i < dest.size(); ++i)
+        dest[i] = fromValues(values + i * valuesPerSection);
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void CoefficientCache::storeCut(bool highCut, float freq, Slope slope, double sampleRate,
+                                const std::array<BiquadCoefficients, 4>& sections) noexcept
+{
+    double values[4 * valuesPerSection];
+    for (size_t i = 0; i < sections.size(); ++i)
+        toValues(sections[i], values + i * valuesPerSection);
+    cuts.store(makeCutKey(highCut, freq, slope, sampleRate), values);
+}
+
+bool CoefficientCache::findBand(const BandSettings& band, double sampleRate, BiquadCoefficients& dest) noexcept
+{
+    double values[valuesPerSection];
+    if (! bands.find(makeBandKey(band, sampleRate), values))
+    {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    dest = fromValues(values);
+    hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void CoefficientCache::storeBand(const BandSettings& band, double sampleRate, const BiquadCoefficients& section) noexcept
+{
+    double values[valuesPerSection];
+    toValues(section, values);
+    bands.store(makeBandKey(band, sampleRate), values);
+}
+
+CoefficientCache::Statistics CoefficientCache::getStatistics() const noexcept
+{
+    return { hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed) };
+}
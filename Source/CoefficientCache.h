@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+    Process-wide cache of designed cut filters and bands, so instances with the
+    same settings at the same rate design them once between them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterChain.h"
+
+// Keyed by the exact settings and sample rate. Every parameter already snaps to its
+// interval (1 Hz, 0.5 dB, 0.05 Q), so equal settings on different instances are bit for
+// bit equal floats, and a hit returns exactly what designing would have.
+//
+// Two fixed tables, one for cut filters and one for bands, make up all the memory the
+// cache will ever use. Each slot is a seqlock: a reader copies the entry out and keeps it
+// only if the slot's sequence didn't move meanwhile; a writer claims the slot with a
+// compare-exchange and simply skips caching if somebody else holds it. Neither side ever
+// blocks or allocates, so lookups are safe on any thread, the audio thread included. A
+// new entry takes the first free slot in its short probe window, or else evicts one.
+//
+// Entries are a few hundred bytes at most, so copying one out costs less than sharing it
+// through a reference count would, and nothing has to be reclaimed.
+class CoefficientCache
+{
+public:
+    static CoefficientCache& getInstance();
+
+    bool findCut(bool highCut, float freq, Slope slope, double sampleRate, std::array<BiquadCoefficients, 4>& dest) noexcept;
+    void storeCut(bool highCut, float freq, Slope slope, double sampleRate, const std::array<BiquadCoefficients, 4>& sections) noexcept;
+
+    bool findBand(const BandSettings& band, double sampleRate, BiquadCoefficients& dest) noexcept;
+    void storeBand(const BandSettings& band, double sampleRate, const BiquadCoefficients& section) noexcept;
+
+    struct Statistics
+    {
+        juce::uint64 hits { 0 }, misses { 0 };
+    };
+
+    Statistics getStatistics() const noexcept;
+
+private:
+    CoefficientCache() = default;
+
+    static constexpr int keyWords = 3;
+    using Key = std::array<juce::uint64, keyWords>;
+
+    template <int NumSlots, int NumValues>
+    class Table
+    {
+    public:
+        bool find(const Key& key, double* dest) noexcept;
+        void store(const Key& key, const double* values) noexcept;
+
+    private:
+        static constexpr int probeLength = 4;
+
+        struct Slot
+        {
+            // Even while stable, odd while being written; 0 for never written
+            std::atomic<juce::uint32> sequence { 0 };
+            std::array<std::atomic<juce::uint64>, keyWords> key {};
+            std::array<std::atomic<juce::uint64>, NumValues> values {};
+        };
+
+        static juce::uint64 hash(const Key& key) noexcept;
+
+        std::array<Slot, NumSlots> slots;
+    };
+
+    static Key makeCutKey(bool highCut, float freq, Slope slope, double sampleRate) noexcept;
+    static Key makeBandKey(const BandSettings& band, double sampleRate) noexcept;
+
+    static constexpr int valuesPerSection = 5;
+
+    Table<1024, 4 * valuesPerSection> cuts;
+    Table<4096, valuesPerSection> bands;
+    std::atomic<juce::uint64> hits { 0 }, misses { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (CoefficientCache)
+};
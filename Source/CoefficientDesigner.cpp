@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientDesigner.h"
+#include "CoefficientCache.h"
+
+namespace
+{
+    constexpr int pollIntervalMs = 2;
+}
+
+CoefficientDesigner::DesignerThread::DesignerThread() : juce::Thread("EQ coefficient designer")
+{
+    startThread(3);
+}
+
+CoefficientDesigner::DesignerThread::~DesignerThread()
+{
+    stopThread(1000);
+}
+
+void CoefficientDesigner::DesignerThread::add(CoefficientDesigner* designer)
+{
+    const juce::ScopedLock sl(lock);
+    designers.addIfNotAlreadyThere(designer);
+}
+
+void CoefficientDesigner::DesignerThread::remove(CoefficientDesigner* designer)
+{
+    const juce::ScopedLock sl(lock);
+    designers.removeFirstMatchingValue(designer);
+}
+
+void CoefficientDesigner::DesignerThread::run()
+{
+    while (! threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            for (auto* designer : designers)
+                designer->designIfChanged();
+        }
+        wait(pollIntervalMs);
+    }
+}
+
+//==============================================================================
+CoefficientDesigner::CoefficientDesigner(const ChainParameters& p) : parameters(p)
+{
+}
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+    release();
+}
+
+void CoefficientDesigner::prepare(double sampleRate)
+{
+    release();
+    {
+        const juce::ScopedLock sl(designLock);
+        designedVersion = version.load();
+        hostSampleRate = sampleRate;
+        designAll(parameters.load());
+        buffer.getWriteBuffer() = current;
+        buffer.publish();
+    }
+    designerThread->add(this);
+    registered = true;
+}
+
+void CoefficientDesigner::release()
+{
+    if (registered)
+    {
+        designerThread->remove(this);
+        registered = false;
+    }
+}
+
+void CoefficientDesigner::designAll(const ChainSettings& settings)
+{
+    const auto lowCutRevision = current.lowCutRevision;
+    const auto highCutRevision = current.highCutRevision;
+    const auto bandRevisions = current.bandRevisions;
+
+    current = makeChainCoefficients(settings, hostSampleRate);
+
+    // Keep revisions increasing, so consumers never mistake a new band for one they hold
+    current.lowCutRevision += lowCutRevision;
+    current.highCutRevision += highCutRevision;
+    for (size_t i = 0; i < bandRevisions.size(); ++i)
+        current.bandRevisions[i] += bandRevisions[i];
+}
+
+void CoefficientDesigner::designIfChanged()
+{
+    const juce::ScopedLock sl(designLock);
+    const auto newVersion = version.load();
+    if (newVersion == designedVersion)
+        return;
+    designedVersion = newVersion;
+
+    auto settings = parameters.load();
+    if (! sameOversampling(settings, current.settings))
+    {
+        // A new oversampling mode means every band has to be redesigned for the new rate
+        designAll(settings);
+        buffer.getWriteBuffer() = current;
+        buffer.publish();
+        return;
+    }
+
+    // Instances with the same settings share their designs through the cache
+    auto& cache = CoefficientCache::getInstance();
+
+    bool changed = false;
+    if (! sameLowCut(settings, current.settings))
+    {
+        designLowCut(current, settings, &cache);
+        changed = true;
+    }
+    if (! sameHighCut(settings, current.settings))
+    {
+        designHighCut(current, settings, &cache);
+        changed = true;
+    }
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (! sameBand(settings.bands[(size_t) band], current.settings.bands[(size_t) band]))
+        {
+            designBand(current, settings, band, nullptr, &cache);
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        buffer.getWriteBuffer() = current;
+        buffer.publish();
+    }
+}
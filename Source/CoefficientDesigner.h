@@ -0,0 +1,72 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.h
+    Designs ChainCoefficients away from the audio thread and hands them over
+    through a TripleBuffer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterChain.h"
+#include "TripleBuffer.h"
+
+class CoefficientDesigner
+{
+public:
+    explicit CoefficientDesigner(const ChainParameters& parameters);
+    ~CoefficientDesigner();
+
+    // Designs the current settings synchronously, publishes them, and from then on
+    // lets the shared designer thread pick up parameter changes.
+    void prepare(double sampleRate);
+    void release();
+
+    // Wait-free; safe to call from any thread, including the audio thread.
+    void parametersChanged() noexcept { version.fetch_add(1); }
+
+    // Audio thread only. Returns the newest coefficient set if one has been published
+    // since the last call, or nullptr if nothing changed.
+    const ChainCoefficients* acquire() noexcept
+    {
+        return buffer.update() ? &buffer.getReadBuffer() : nullptr;
+    }
+
+    //==============================================================================
+    // One thread per process serves every designer instance, polling their versions.
+    class DesignerThread : public juce::Thread
+    {
+    public:
+        DesignerThread();
+        ~DesignerThread() override;
+
+        void add(CoefficientDesigner*);
+        void remove(CoefficientDesigner*);
+        void run() override;
+
+    private:
+        juce::CriticalSection lock;
+        juce::Array<CoefficientDesigner*> designers;
+    };
+
+private:
+    void designAll(const ChainSettings& settings);
+    void designIfChanged();
+
+    const ChainParameters& parameters;
+    std::atomic<juce::uint32> version { 1 };
+    juce::uint32 designedVersion { 0 };
+    double hostSampleRate { 0 };
+
+    // Owned by whichever thread holds designLock; only ever copied into the buffer.
+    ChainCoefficients current;
+    juce::CriticalSection designLock;
+    TripleBuffer<ChainCoefficients> buffer;
+
+    juce::SharedResourcePointer<DesignerThread> designerThread;
+    bool registered { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CoefficientDesigner)
+};
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    DspLoadMonitor.cpp
+
+  ==============================================================================
+*/
+
+#include "DspLoadMonitor.h"
+
+namespace
+{
+    // Max load is kept as an integer so it can be raised with a compare-exchange
+    constexpr double microScale = 1.0e6;
+
+    std::atomic<int> nextInstance { 1 };
+}
+
+DspLoadMonitor::DspLoadMonitor()
+    : instance(nextInstance.fetch_add(1)),
+      secondsPerTick(1.0 / (double) juce::Time::getHighResolutionTicksPerSecond())
+{
+}
+
+void DspLoadMonitor::prepare(double newSampleRate) noexcept
+{
+    sampleRate.store(newSampleRate);
+    reset();
+}
+
+void DspLoadMonitor::reset() noexcept
+{
+    for (auto* counter : { &numBlocks, &numSamples, &overBudgetBlocks, &redesigns, &busyTicks, &maxLoadMicro })
+        counter->store(0, std::memory_order_relaxed);
+
+    for (auto& bin : loadHistogram)
+        bin.store(0, std::memory_order_relaxed);
+    for (auto& bin : timeHistogram)
+        bin.store(0, std::memory_order_relaxed);
+}
+
+void DspLoadMonitor::addBlock(juce::int64 ticks, int blockSamples) noexcept
+{
+    const auto rate = sampleRate.load(std::memory_order_relaxed);
+    if (blockSamples <= 0 || rate <= 0 || ticks < 0)
+        return;
+
+    const auto seconds = (double) ticks * secondsPerTick;
+    const auto load = seconds * rate / blockSamples;
+
+    numBlocks.fetch_add(1, std::memory_order_relaxed);
+    numSamples.fetch_add((juce::uint64) blockSamples, std::memory_order_relaxed);
+    busyTicks.fetch_add((juce::uint64) ticks, std::memory_order_relaxed);
+
+    if (load >= 1.0)
+        overBudgetBlocks.fetch_add(1, std::memory_order_relaxed);
+
+    const auto loadBin = juce::jmin(numLoadBins - 1, (int) (load * (numLoadBins / maxBinnedLoad)));
+    loadHistogram[(size_t) loadBin].fetch_add(1, std::memory_order_relaxed);
+
+    const auto micros = (juce::uint32) juce::jmin(seconds * microScale, (double) std::numeric_limits<juce::uint32>::max());
+    const auto timeBin = juce::jmin(numTimeBins - 1, micros == 0 ? 0 : juce::findHighestSetBit(micros) + 1);
+    timeHistogram[(size_t) timeBin].fetch_add(1, std::memory_order_relaxed);
+
+    const auto loadMicro = (juce::uint64) (load * microScale);
+    auto previousMax = maxLoadMicro.load(std::memory_order_relaxed);
+    while (loadMicro > previousMax
+           && ! maxLoadMicro.compare_exchange_weak(previousMax, loadMicro, std::memory_order_relaxed))
+    {
+    }
+}
+
+DspLoadMonitor::Snapshot DspLoadMonitor::getSnapshot() const noexcept
+{
+    Snapshot s;
+    s.instance = instance;
+    s.sampleRate = sampleRate.load(std::memory_order_relaxed);
+    s.numBlocks = numBlocks.load(std::memory_order_relaxed);
+    s.numSamples = numSamples.load(std::memory_order_relaxed);
+    s.overBudgetBlocks = overBudgetBlocks.load(std::memory_order_relaxed);
+    s.redesigns = redesigns.load(std::memory_order_relaxed);
+    s.busySeconds = (double) busyTicks.load(std::memory_order_relaxed) * secondsPerTick;
+    s.maxLoad = (double) maxLoadMicro.load(std::memory_order_relaxed) / microScale;
+
+    for (size_t i = 0; i < loadHistogram.size(); ++i)
+        s.loadHistogram[i] = loadHistogram[i].load(std::memory_order_relaxed);
+    for (size_t i = 0; i < timeHistogram.size(); ++i)
+        s.timeHistogram[i] = timeHistogram[i].load(std::memory_order_relaxed);
+
+    return s;
+}
+
+double DspLoadMonitor::Snapshot::getLoadPercentile(double fraction) const noexcept
+{
+    juce::uint64 total = 0;
+    for (auto count : loadHistogram)
+        total += count;
+
+    if (total == 0)
+        return 0.0;
+
+    const auto target = (juce::uint64) std::ceil(fraction * (double) total);
+    juce::uint64 seen = 0;
+    for (int i = 0; i < numLoadBins - 1; ++i)
+    {
+        seen += loadHistogram[(size_t) i];
+        if (seen >= target)
+            return (i + 1) * (maxBinnedLoad / numLoadBins);
+    }
+
+    // The last bin is open ended, so the best bound there is the largest load seen
+    return maxLoad;
+}
+
+juce::String DspLoadMonitor::dump() const
+{
+    const auto s = getSnapshot();
+
+    auto toArray = [](const auto& histogram)
+    {
+        juce::Array<juce::var> bins;
+        for (auto count : histogram)
+            bins.add((juce::int64) count);
+        return juce::var(bins);
+    };
+
+    auto* object = new juce::DynamicObject();
+    object->setProperty("instance", s.instance);
+    object->setProperty("sampleRate", s.sampleRate);
+    object->setProperty("blocks", (juce::int64) s.numBlocks);
+    object->setProperty("samples", (juce::int64) s.numSamples);
+    object->setProperty("overBudgetBlocks", (juce::int64) s.overBudgetBlocks);
+    object->setProperty("redesigns", (juce::int64) s.redesigns);
+    object->setProperty("busySeconds", s.busySeconds);
+    object->setProperty("meanLoad", s.getMeanLoad());
+    object->setProperty("p99Load", s.getLoadPercentile(0.99));
+    object->setProperty("maxLoad", s.maxLoad);
+    object->setProperty("loadBinWidth", maxBinnedLoad / numLoadBins);
+    object->setProperty("loadHistogram", toArray(s.loadHistogram));
+    object->setProperty("timeHistogramLog2Micros", toArray(s.timeHistogram));
+
+    return juce::JSON::toString(juce::var(object));
+}
@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    DspLoadMonitor.h
+    Per-instance DSP load telemetry: how long each block took, and how much of
+    its real-time deadline that was.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// The audio thread only ever does relaxed atomic increments, so recording costs a clock
+// read and a handful of uncontended atomics per block, and never locks or allocates.
+// Any thread can take a snapshot at any time; the counters in it may be a block apart
+// from each other, which doesn't matter for statistics.
+//
+// Load is the block's processing time over its duration (numSamples / sampleRate), so
+// anything at or above 1 missed the deadline outright. It is kept in a linear histogram
+// up to twice the deadline, and wall time in a log2 histogram of microseconds.
+class DspLoadMonitor
+{
+public:
+    static constexpr int numLoadBins = 64;
+    static constexpr double maxBinnedLoad = 2.0;
+    static constexpr int numTimeBins = 24;      // 1 us to 8 s
+
+    DspLoadMonitor();
+
+    // Message thread, before processing starts
+    void prepare(double sampleRate) noexcept;
+
+    // Any thread. Clears every counter.
+    void reset() noexcept;
+
+    // Audio thread. Times the enclosing scope as one block of numSamples.
+    class ScopedBlock
+    {
+    public:
+        ScopedBlock(DspLoadMonitor& m, int n) noexcept
+            : monitor(m), numSamples(n), startTicks(juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedBlock() noexcept   { monitor.addBlock(juce::Time::getHighResolutionTicks() - startTicks, numSamples); }
+
+    private:
+        DspLoadMonitor& monitor;
+        int numSamples;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+    };
+
+    // Audio thread. Counts sections redesigned on the audio thread.
+    void addRedesigns(int numSections) noexcept    { redesigns.fetch_add((juce::uint64) numSections, std::memory_order_relaxed); }
+
+    struct Snapshot
+    {
+        int instance { 0 };
+        double sampleRate { 0 };
+        juce::uint64 numBlocks { 0 }, numSamples { 0 }, overBudgetBlocks { 0 }, redesigns { 0 };
+        double busySeconds { 0 }, maxLoad { 0 };
+        std::array<juce::uint64, numLoadBins> loadHistogram {};
+        std::array<juce::uint64, numTimeBins> timeHistogram {};
+
+        double getAudioSeconds() const noexcept   { return sampleRate > 0 ? (double) numSamples / sampleRate : 0.0; }
+        double getMeanLoad() const noexcept       { return getAudioSeconds() > 0 ? busySeconds / getAudioSeconds() : 0.0; }
+
+        // Upper edge of the histogram bin holding the given fraction of blocks
+        double getLoadPercentile(double fraction) const noexcept;
+    };
+
+    Snapshot getSnapshot() const noexcept;
+
+    // Everything in the snapshot as JSON, for logs and bug reports
+    juce::String dump() const;
+
+private:
+    void addBlock(juce::int64 ticks, int numSamples) noexcept;
+
+    const int instance;
+    std::atomic<double> sampleRate { 0 };
+    double secondsPerTick { 0 };
+
+    std::atomic<juce::uint64> numBlocks { 0 }, numSamples { 0 }, overBudgetBlocks { 0 }, redesigns { 0 };
+    std::atomic<juce::uint64> busyTicks { 0 }, maxLoadMicro { 0 };
+    std::array<std::atomic<juce::uint64>, numLoadBins> loadHistogram {};
+    std::array<std::atomic<juce::uint64>, numTimeBins> timeHistogram {};
+
+    JUCE_DECLARE_NON_COPYABLE (DspLoadMonitor)
+};
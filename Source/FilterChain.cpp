@@ -0,0 +1,426 @@
+/*
+  ==============================================================================
+
+    FilterChain.cpp
+
+  ==============================================================================
+*/
+
+#include "FilterChain.h"
+#include "BandDesignTable.h"
+#include "CoefficientCache.h"
+
+namespace
+{
+    juce::String makeBandParameterID(int band, const juce::String& name)
+    {
+        if (band == 0)
+            return "Peak " + name;
+        return "Band " + juce::String(band + 1) + " " + name;
+    }
+}
+
+juce::String getBandParameterID(int band, const juce::String& name)
+{
+    // Built once per process. juce::String copies share their text, so every instance's
+    // parameters end up pointing at these rather than holding their own.
+    static const juce::StringArray names { "Freq", "Gain", "Quality", "Type", "Enabled" };
+    static const auto ids = []
+    {
+        std::array<juce::StringArray, maxBands> result;
+        for (int b = 0; b < maxBands; ++b)
+            for (const auto& n : names)
+                result[(size_t) b].add(makeBandParameterID(b, n));
+        return result;
+    }();
+
+    const auto index = names.indexOf(name);
+    if (juce::isPositiveAndBelow(band, maxBands) && index >= 0)
+        return ids[(size_t) band][index];
+    return makeBandParameterID(band, name);
+}
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+{
+    ChainSettings settings;
+    for (int i = 0; i < maxBands; ++i)
+    {
+        auto& band = settings.bands[(size_t) i];
+        band.enabled = apvts.getRawParameterValue(getBandParameterID(i, "Enabled"))->load() > 0.5f;
+        band.type = static_cast<BandType>(apvts.getRawParameterValue(getBandParameterID(i, "Type"))->load());
+        band.freq = apvts.getRawParameterValue(getBandParameterID(i, "Freq"))->load();
+        band.gainDecibels = apvts.getRawParameterValue(getBandParameterID(i, "Gain"))->load();
+        band.quality = apvts.getRawParameterValue(getBandParameterID(i, "Quality"))->load();
+    }
+    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
+    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
+    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
+    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    settings.oversamplingFactor = 1 << static_cast<int>(apvts.getRawParameterValue("Oversampling")->load());
+    settings.linearPhaseOversampling = apvts.getRawParameterValue("Oversampling Filter")->load() > 0.5f;
+    settings.linearPhase = apvts.getRawParameterValue("EQ Mode")->load() > 0.5f;
+    settings.linearPhaseLength = 2048 << static_cast<int>(apvts.getRawParameterValue("Linear Phase Length")->load());
+    settings.linearPhaseBlockSize = 128 << static_cast<int>(apvts.getRawParameterValue("Linear Phase Block")->load());
+    return settings;
+}
+
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts)
+    : lowCutFreq(dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("LowCut Freq"))),
+      highCutFreq(dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter("HighCut Freq"))),
+      lowCutSlope(dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("LowCut Slope"))),
+      highCutSlope(dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("HighCut Slope"))),
+      oversampling(dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("Oversampling"))),
+      oversamplingFilter(dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("Oversampling Filter"))),
+      eqMode(dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("EQ Mode"))),
+      linearPhaseLength(dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("Linear Phase Length"))),
+      linearPhaseBlockSize(dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter("Linear Phase Block"))),
+      parallelChannels(dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter("Parallel Channels")))
+{
+    for (int i = 0; i < maxBands; ++i)
+    {
+        auto& band = bands[(size_t) i];
+        band.enabled = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(getBandParameterID(i, "Enabled")));
+        band.type = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(getBandParameterID(i, "Type")));
+        band.freq = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(getBandParameterID(i, "Freq")));
+        band.gain = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(getBandParameterID(i, "Gain")));
+        band.quality = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(getBandParameterID(i, "Quality")));
+        jassert(band.enabled != nullptr && band.type != nullptr && band.freq != nullptr
+                && band.gain != nullptr && band.quality != nullptr);
+    }
+
+    jassert(lowCutFreq != nullptr && highCutFreq != nullptr && lowCutSlope != nullptr && highCutSlope != nullptr
+            && oversampling != nullptr && oversamplingFilter != nullptr
+            && eqMode != nullptr && linearPhaseLength != nullptr && linearPhaseBlockSize != nullptr
+            && parallelChannels != nullptr);
+}
+
+ChainSettings ChainParameters::load() const
+{
+    ChainSettings settings;
+    for (size_t i = 0; i < bands.size(); ++i)
+    {
+        auto& band = settings.bands[i];
+        band.enabled = bands[i].enabled->get();
+        band.type = static_cast<BandType>(bands[i].type->getIndex());
+        band.freq = bands[i].freq->get();
+        band.gainDecibels = bands[i].gain->get();
+        band.quality = bands[i].quality->get();
+    }
+    settings.lowCutFreq = lowCutFreq->get();
+    settings.highCutFreq = highCutFreq->get();
+    settings.lowCutSlope = static_cast<Slope>(lowCutSlope->getIndex());
+    settings.highCutSlope = static_cast<Slope>(highCutSlope->getIndex());
+    settings.oversamplingFactor = 1 << oversampling->getIndex();
+    settings.linearPhaseOversampling = oversamplingFilter->getIndex() == 1;
+    settings.linearPhase = eqMode->getIndex() == 1;
+    settings.linearPhaseLength = 2048 << linearPhaseLength->getIndex();
+    settings.linearPhaseBlockSize = 128 << linearPhaseBlockSize->getIndex();
+    return settings;
+}
+
+//==============================================================================
+double getMagnitudeForFrequency(const BiquadCoefficients& c, double frequency, double sampleRate)
+{
+    jassert(frequency >= 0 && frequency <= sampleRate * 0.5);
+
+    const auto jw = std::exp(std::complex<double>(0.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate));
+    const auto jw2 = jw * jw;
+    const auto numerator = c.b0 + c.b1 * jw + c.b2 * jw2;
+    const auto denominator = 1.0 + c.a1 * jw + c.a2 * jw2;
+
+    return std::abs(numerator / denominator);
+}
+
+double getMagnitudeForFrequency(const ChainCoefficients& coefficients, double frequency)
+{
+    const auto sampleRate = coefficients.sampleRate;
+    auto mag = 1.0;
+
+    for (const auto& band : coefficients.bands)
+        if (! isIdentity(band))
+            mag *= getMagnitudeForFrequency(band, frequency, sampleRate);
+
+    for (int i = 0; i <= coefficients.settings.lowCutSlope; ++i)
+        mag *= getMagnitudeForFrequency(coefficients.lowCut[(size_t) i], frequency, sampleRate);
+    for (int i = 0; i <= coefficients.settings.highCutSlope; ++i)
+        mag *= getMagnitudeForFrequency(coefficients.highCut[(size_t) i], frequency, sampleRate);
+
+    return mag;
+}
+
+namespace
+{
+    constexpr double maxTailLengthSeconds = 10.0;
+
+    // Largest pole radius of 1 + a1 z^-1 + a2 z^-2
+    double getPoleRadius(const BiquadCoefficients& c)
+    {
+        const auto discriminant = c.a1 * c.a1 - 4.0 * c.a2;
+        if (discriminant < 0)
+            return std::sqrt(c.a2);     // a complex pair, whose product is a2
+
+        const auto root = std::sqrt(discriminant);
+        return 0.5 * juce::jmax(std::abs(-c.a1 + root), std::abs(-c.a1 - root));
+    }
+
+    // Samples until the slowest pole has decayed by the given factor. The two extra
+    // samples cover the numerator, which alone is an FIR that long.
+    double getDecaySamples(const BiquadCoefficients& c, double logDecay)
+    {
+        const auto radius = getPoleRadius(c);
+        if (radius <= 0)
+            return 2.0;
+        if (radius >= 1)
+            return std::numeric_limits<double>::max();
+        return 2.0 + logDecay / std::log(radius);
+    }
+}
+
+double getTailLengthSeconds(const ChainCoefficients& coefficients, double decibelsDown)
+{
+    if (coefficients.sampleRate <= 0)
+        return 0;
+
+    const auto logDecay = -decibelsDown / 20.0 * std::log(10.0);
+    const auto maxSamples = maxTailLengthSeconds * coefficients.sampleRate;
+    auto samples = 0.0;
+
+    for (const auto& band : coefficients.bands)
+        if (! isIdentity(band))
+            samples += juce::jmin(maxSamples, getDecaySamples(band, logDecay));
+
+    for (int i = 0; i <= coefficients.settings.lowCutSlope; ++i)
+        samples += juce::jmin(maxSamples, getDecaySamples(coefficients.lowCut[(size_t) i], logDecay));
+    for (int i = 0; i <= coefficients.settings.highCutSlope; ++i)
+        samples += juce::jmin(maxSamples, getDecaySamples(coefficients.highCut[(size_t) i], logDecay));
+
+    return juce::jmin(maxTailLengthSeconds, samples / coefficients.sampleRate);
+}
+
+namespace
+{
+    // 1 / Q of each second order section of the Butterworth filter behind each slope, i.e.
+    // 2 cos((2k + 1) pi / (2 order)) for the pole pair at that angle. Indexed by slope,
+    // then section.
+    constexpr double butterworthInverseQ[4][4] =
+    {
+        { 1.4142135623730951 },
+        { 1.8477590650225735, 0.76536686473017967 },
+        { 1.9318516525781366, 1.4142135623730951, 0.51763809020504148 },
+        { 1.9615705608064609, 1.6629392246050905, 1.1111404660392046, 0.39018064403225666 }
+    };
+}
+
+BiquadCoefficients makePeakBiquad(double sampleRate, float frequency, float quality, float gainDecibels)
+{
+    jassert(sampleRate > 0.0);
+    jassert(frequency > 0 && frequency <= static_cast<float>(sampleRate * 0.5));
+    jassert(quality > 0);
+
+    const auto A = std::sqrt(juce::Decibels::decibelsToGain(static_cast<double>(gainDecibels)));
+    const auto omega = (juce::MathConstants<double>::twoPi * frequency) / sampleRate;
+    const auto alpha = std::sin(omega) / (quality * 2.0);
+    const auto c2 = -2.0 * std::cos(omega);
+    const auto alphaTimesA = alpha * A;
+    const auto alphaOverA = alpha / A;
+
+    return normaliseBiquad(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA, 1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+}
+
+BiquadCoefficients makeLowShelfBiquad(double sampleRate, float frequency, float quality, float gainDecibels)
+{
+    jassert(sampleRate > 0.0);
+    jassert(frequency > 0 && frequency <= static_cast<float>(sampleRate * 0.5));
+    jassert(quality > 0);
+
+    const auto A = std::sqrt(juce::Decibels::decibelsToGain(static_cast<double>(gainDecibels)));
+    const auto aminus1 = A - 1.0;
+    const auto aplus1 = A + 1.0;
+    const auto omega = (juce::MathConstants<double>::twoPi * frequency) / sampleRate;
+    const auto coso = std::cos(omega);
+    const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+    const auto aminus1TimesCoso = aminus1 * coso;
+
+    return normaliseBiquad(A * (aplus1 - aminus1TimesCoso + beta),
+                           A * 2.0 * (aminus1 - aplus1 * coso),
+                           A * (aplus1 - aminus1TimesCoso - beta),
+                           aplus1 + aminus1TimesCoso + beta,
+                           -2.0 * (aminus1 + aplus1 * coso),
+                           aplus1 + aminus1TimesCoso - beta);
+}
+
+BiquadCoefficients makeHighShelfBiquad(double sampleRate, float frequency, float quality, float gainDecibels)
+{
+    jassert(sampleRate > 0.0);
+    jassert(frequency > 0 && frequency <= static_cast<float>(sampleRate * 0.5));
+    jassert(quality > 0);
+
+    const auto A = std::sqrt(juce::Decibels::decibelsToGain(static_cast<double>(gainDecibels)));
+    const auto aminus1 = A - 1.0;
+    const auto aplus1 = A + 1.0;
+    const auto omega = (juce::MathConstants<double>::twoPi * frequency) / sampleRate;
+    const auto coso = std::cos(omega);
+    const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+    const auto aminus1TimesCoso = aminus1 * coso;
+
+    return normaliseBiquad(A * (aplus1 + aminus1TimesCoso + beta),
+                           A * -2.0 * (aminus1 + aplus1 * coso),
+                           A * (aplus1 + aminus1TimesCoso - beta),
+                           aplus1 - aminus1TimesCoso + beta,
+                           2.0 * (aminus1 - aplus1 * coso),
+                           aplus1 - aminus1TimesCoso - beta);
+}
+
+BiquadCoefficients makeNotchBiquad(double sampleRate, float frequency, float quality)
+{
+    jassert(sampleRate > 0.0);
+    jassert(frequency > 0 && frequency <= static_cast<float>(sampleRate * 0.5));
+    jassert(quality > 0);
+
+    const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / quality;
+
+    return normaliseBiquad(nSquared + 1.0, 2.0 * (1.0 - nSquared), nSquared + 1.0,
+                           1.0 + n * invQ + nSquared, 2.0 * (1.0 - nSquared), 1.0 - n * invQ + nSquared);
+}
+
+BiquadCoefficients makeBandBiquad(double sampleRate, const BandSettings& band)
+{
+    if (isFlat(band))
+        return {};
+
+    switch (band.type)
+    {
+        case BandType_LowShelf:  return makeLowShelfBiquad(sampleRate, band.freq, band.quality, band.gainDecibels);
+        case BandType_HighShelf: return makeHighShelfBiquad(sampleRate, band.freq, band.quality, band.gainDecibels);
+        case BandType_Notch:     return makeNotchBiquad(sampleRate, band.freq, band.quality);
+        case BandType_Peak:
+        default:                 return makePeakBiquad(sampleRate, band.freq, band.quality, band.gainDecibels);
+    }
+}
+
+BiquadCoefficients makeHighPassBiquad(double sampleRate, float frequency, double quality)
+{
+    jassert(sampleRate > 0.0);
+    jassert(frequency > 0 && frequency <= static_cast<float>(sampleRate * 0.5));
+
+    const auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / quality;
+
+    return normaliseBiquad(1.0, -2.0, 1.0, 1.0 + invQ * n + nSquared, 2.0 * (nSquared - 1.0), 1.0 - invQ * n + nSquared);
+}
+
+BiquadCoefficients makeLowPassBiquad(double sampleRate, float frequency, double quality)
+{
+    jassert(sampleRate > 0.0);
+    jassert(frequency > 0 && frequency <= static_cast<float>(sampleRate * 0.5));
+
+    const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+    const auto invQ = 1.0 / quality;
+
+    return normaliseBiquad(1.0, 2.0, 1.0, 1.0 + invQ * n + nSquared, 2.0 * (1.0 - nSquared), 1.0 - invQ * n + nSquared);
+}
+
+// All sections of a cut filter share the same corner, so the bilinear transform's
+// prewarping is worked out once and only the per-section Q comes from the table.
+void makeLowCutSections(std::array<BiquadCoefficients, 4>& sections, double sampleRate, float frequency, Slope slope)
+{
+    jassert(sampleRate > 0.0);
+    jassert(frequency > 0 && frequency <= static_cast<float>(sampleRate * 0.5));
+
+    const auto n = std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+
+    for (int i = 0; i <= slope; ++i)
+    {
+        const auto invQ = butterworthInverseQ[slope][i];
+        sections[(size_t) i] = normaliseBiquad(1.0, -2.0, 1.0, 1.0 + invQ * n + nSquared, 2.0 * (nSquared - 1.0), 1.0 - invQ * n + nSquared);
+    }
+}
+
+void makeHighCutSections(std::array<BiquadCoefficients, 4>& sections, double sampleRate, float frequency, Slope slope)
+{
+    jassert(sampleRate > 0.0);
+    jassert(frequency > 0 && frequency <= static_cast<float>(sampleRate * 0.5));
+
+    const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+    const auto nSquared = n * n;
+
+    for (int i = 0; i <= slope; ++i)
+    {
+        const auto invQ = butterworthInverseQ[slope][i];
+        sections[(size_t) i] = normaliseBiquad(1.0, 2.0, 1.0, 1.0 + invQ * n + nSquared, 2.0 * (1.0 - nSquared), 1.0 - invQ * n + nSquared);
+    }
+}
+
+void designLowCut(ChainCoefficients& coefficients, const ChainSettings& chainSettings, CoefficientCache* cache)
+{
+    const auto freq = chainSettings.lowCutFreq;
+    const auto slope = chainSettings.lowCutSlope;
+    if (cache == nullptr || ! cache->findCut(false, freq, slope, coefficients.sampleRate, coefficients.lowCut))
+    {
+        makeLowCutSections(coefficients.lowCut, coefficients.sampleRate, freq, slope);
+        if (cache != nullptr)
+            cache->storeCut(false, freq, slope, coefficients.sampleRate, coefficients.lowCut);
+    }
+
+    coefficients.settings.lowCutFreq = freq;
+    coefficients.settings.lowCutSlope = slope;
+    ++coefficients.lowCutRevision;
+}
+
+void designHighCut(ChainCoefficients& coefficients, const ChainSettings& chainSettings, CoefficientCache* cache)
+{
+    const auto freq = chainSettings.highCutFreq;
+    const auto slope = chainSettings.highCutSlope;
+    if (cache == nullptr || ! cache->findCut(true, freq, slope, coefficients.sampleRate, coefficients.highCut))
+    {
+        makeHighCutSections(coefficients.highCut, coefficients.sampleRate, freq, slope);
+        if (cache != nullptr)
+            cache->storeCut(true, freq, slope, coefficients.sampleRate, coefficients.highCut);
+    }
+
+    coefficients.settings.highCutFreq = freq;
+    coefficients.settings.highCutSlope = slope;
+    ++coefficients.highCutRevision;
+}
+
+void designBand(ChainCoefficients& coefficients, const ChainSettings& chainSettings, int band,
+                const BandDesignTable* table, CoefficientCache* cache)
+{
+    jassert(table == nullptr || table->getSampleRate() == coefficients.sampleRate);
+
+    const auto& settings = chainSettings.bands[(size_t) band];
+    auto& section = coefficients.bands[(size_t) band];
+    if (table != nullptr)
+    {
+        section = table->makeBandBiquad(settings);
+    }
+    else if (cache == nullptr || ! cache->findBand(settings, coefficients.sampleRate, section))
+    {
+        section = makeBandBiquad(coefficients.sampleRate, settings);
+        if (cache != nullptr)
+            cache->storeBand(settings, coefficients.sampleRate, section);
+    }
+
+    coefficients.settings.bands[(size_t) band] = settings;
+    ++coefficients.bandRevisions[(size_t) band];
+}
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    auto& cache = CoefficientCache::getInstance();
+
+    ChainCoefficients coefficients;
+    coefficients.sampleRate = sampleRate * chainSettings.oversamplingFactor;
+    coefficients.settings.oversamplingFactor = chainSettings.oversamplingFactor;
+    coefficients.settings.linearPhaseOversampling = chainSettings.linearPhaseOversampling;
+    designLowCut(coefficients, chainSettings, &cache);
+    designHighCut(coefficients, chainSettings, &cache);
+    for (int band = 0; band < maxBands; ++band)
+        designBand(coefficients, chainSettings, band, nullptr, &cache);
+    return coefficients;
+}
@@ -0,0 +1,194 @@
+/*
+  ==============================================================================
+
+    FilterChain.h
+    Settings, coefficient sets and helpers shared by the processor, the
+    coefficient designer and the editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+enum Slope
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48
+};
+
+enum BandType
+{
+    BandType_Peak,
+    BandType_LowShelf,
+    BandType_HighShelf,
+    BandType_Notch
+};
+
+// Parametric bands per instance. Band 0 is the original peak band and keeps its
+// parameter IDs, so existing sessions load unchanged.
+constexpr int maxBands = 16;
+
+struct BandSettings
+{
+    bool enabled { false };
+    BandType type { BandType_Peak };
+    float freq { 1000.f }, gainDecibels { 0 }, quality { 1.f };
+};
+
+struct ChainSettings
+{
+    std::array<BandSettings, maxBands> bands;
+    float lowCutFreq { 0 }, highCutFreq { 0 };
+    Slope lowCutSlope { Slope::Slope_12 }, highCutSlope { Slope::Slope_12 };
+
+    // The chain runs at oversamplingFactor times the host rate (1, 2 or 4)
+    int oversamplingFactor { 1 };
+    bool linearPhaseOversampling { false };
+
+    // Linear phase mode replaces the IIR cascade with an FIR of linearPhaseLength taps
+    // that has the same magnitude response, convolved in linearPhaseBlockSize partitions
+    bool linearPhase { false };
+    int linearPhaseLength { 8192 }, linearPhaseBlockSize { 512 };
+};
+
+// A disabled band, or a peak or shelf at 0 dB, which does nothing. The designers return
+// the exact identity section for these rather than one that rounding leaves an ulp off.
+inline bool isFlat(const BandSettings& band) noexcept
+{
+    return ! band.enabled || (band.type != BandType_Notch && band.gainDecibels == 0);
+}
+
+inline bool sameBand(const BandSettings& a, const BandSettings& b)
+{
+    return a.enabled == b.enabled && a.type == b.type && a.freq == b.freq
+        && a.gainDecibels == b.gainDecibels && a.quality == b.quality;
+}
+
+inline bool sameLowCut(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.lowCutFreq == b.lowCutFreq && a.lowCutSlope == b.lowCutSlope;
+}
+
+inline bool sameHighCut(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.highCutFreq == b.highCutFreq && a.highCutSlope == b.highCutSlope;
+}
+
+inline bool sameOversampling(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.oversamplingFactor == b.oversamplingFactor && a.linearPhaseOversampling == b.linearPhaseOversampling;
+}
+
+// "Peak Freq", "Band 2 Freq", ... for name "Freq"; likewise "Gain", "Quality", "Type"
+// and "Enabled".
+juce::String getBandParameterID(int band, const juce::String& name);
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+
+// Typed handles to the parameters a ChainSettings is built from. The string ID lookup
+// happens once at construction, so load() is just a handful of atomic reads.
+struct ChainParameters
+{
+    explicit ChainParameters(juce::AudioProcessorValueTreeState& apvts);
+    ChainSettings load() const;
+
+    struct BandParameters
+    {
+        juce::AudioParameterBool* enabled;
+        juce::AudioParameterChoice* type;
+        juce::AudioParameterFloat* freq;
+        juce::AudioParameterFloat* gain;
+        juce::AudioParameterFloat* quality;
+    };
+
+    std::array<BandParameters, maxBands> bands;
+    juce::AudioParameterFloat* lowCutFreq;
+    juce::AudioParameterFloat* highCutFreq;
+    juce::AudioParameterChoice* lowCutSlope;
+    juce::AudioParameterChoice* highCutSlope;
+    juce::AudioParameterChoice* oversampling;
+    juce::AudioParameterChoice* oversamplingFilter;
+    juce::AudioParameterChoice* eqMode;
+    juce::AudioParameterChoice* linearPhaseLength;
+    juce::AudioParameterChoice* linearPhaseBlockSize;
+    juce::AudioParameterBool* parallelChannels;
+};
+
+//==============================================================================
+// One second order section, normalised so that a0 == 1. Sections are designed and kept
+// in double precision; each processing path rounds them to its own sample type.
+struct BiquadCoefficients
+{
+    double b0 { 1 }, b1 { 0 }, b2 { 0 }, a1 { 0 }, a2 { 0 };
+};
+
+inline bool isIdentity(const BiquadCoefficients& c) noexcept
+{
+    return c.b0 == 1 && c.b1 == c.a1 && c.b2 == c.a2;
+}
+
+inline BiquadCoefficients normaliseBiquad(double b0, double b1, double b2, double a0, double a1, double a2) noexcept
+{
+    const auto a0Inv = 1.0 / a0;
+    return { b0 * a0Inv, b1 * a0Inv, b2 * a0Inv, a1 * a0Inv, a2 * a0Inv };
+}
+
+// A complete, self-contained coefficient set for the low cut, high cut and parametric
+// bands. A flat band (see isFlat()) is an exact identity section.
+// The revision numbers change whenever the matching band is redesigned, so a consumer
+// can skip bands that are identical to the ones it already holds.
+struct ChainCoefficients
+{
+    ChainSettings settings;
+    double sampleRate { 0 };
+    std::array<BiquadCoefficients, 4> lowCut, highCut;
+    std::array<BiquadCoefficients, maxBands> bands;
+    juce::uint32 lowCutRevision { 0 }, highCutRevision { 0 };
+    std::array<juce::uint32, maxBands> bandRevisions {};
+};
+
+double getMagnitudeForFrequency(const BiquadCoefficients& coefficients, double frequency, double sampleRate);
+
+// Combined magnitude of every active section of the set.
+double getMagnitudeForFrequency(const ChainCoefficients& coefficients, double frequency);
+
+// How long the set's impulse response takes to decay by decibelsDown, from the pole
+// radius of every active section. The sections' decay times are summed, which is an
+// upper bound for the cascade. Allocation-free.
+double getTailLengthSeconds(const ChainCoefficients& coefficients, double decibelsDown);
+
+// Allocation-free designers, safe to call on the audio thread. They produce the same
+// sections as the JUCE IIR::Coefficients / FilterDesign Butterworth methods. The cut
+// designers fill the first slope + 1 sections from precomputed Butterworth pole angles,
+// at the cost of a single tan whatever the slope.
+BiquadCoefficients makePeakBiquad(double sampleRate, float frequency, float quality, float gainDecibels);
+BiquadCoefficients makeLowShelfBiquad(double sampleRate, float frequency, float quality, float gainDecibels);
+BiquadCoefficients makeHighShelfBiquad(double sampleRate, float frequency, float quality, float gainDecibels);
+BiquadCoefficients makeNotchBiquad(double sampleRate, float frequency, float quality);
+BiquadCoefficients makeBandBiquad(double sampleRate, const BandSettings& band);
+BiquadCoefficients makeHighPassBiquad(double sampleRate, float frequency, double quality);
+BiquadCoefficients makeLowPassBiquad(double sampleRate, float frequency, double quality);
+void makeLowCutSections(std::array<BiquadCoefficients, 4>& sections, double sampleRate, float frequency, Slope slope);
+void makeHighCutSections(std::array<BiquadCoefficients, 4>& sections, double sampleRate, float frequency, Slope slope);
+
+class BandDesignTable;
+class CoefficientCache;
+
+// Redesign single bands of an existing set, recording the settings they were built from
+// and bumping the band's revision. Given a table for the set's sample rate, designBand
+// uses it instead of the exact designers. Given a cache, exact designs are looked up
+// there first and stored for other instances; pass one only for settings that stay put
+// for a while, not for ramp steps, which would just push everything else out.
+void designLowCut(ChainCoefficients& coefficients, const ChainSettings& chainSettings,
+                  CoefficientCache* cache = nullptr);
+void designHighCut(ChainCoefficients& coefficients, const ChainSettings& chainSettings,
+                   CoefficientCache* cache = nullptr);
+void designBand(ChainCoefficients& coefficients, const ChainSettings& chainSettings, int band,
+                const BandDesignTable* table = nullptr, CoefficientCache* cache = nullptr);
+// Designs every band for the rate the chain actually runs at, i.e. the host's sampleRate
+// times the settings' oversampling factor, through the shared CoefficientCache.
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate);
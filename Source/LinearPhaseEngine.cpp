@@ -0,0 +1,331 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEngine.h"
+
+namespace
+{
+    // Kernels take a few milliseconds to design, so there is no point polling faster
+    constexpr int pollIntervalMs = 20;
+
+    int log2(int powerOfTwo) noexcept
+    {
+        jassert(juce::isPowerOfTwo(powerOfTwo));
+        return juce::findHighestSetBit((juce::uint32) powerOfTwo);
+    }
+}
+
+LinearPhaseEngine::KernelThread::KernelThread() : juce::Thread("EQ linear phase kernels")
+{
+    startThread(2);
+}
+
+LinearPhaseEngine::KernelThread::~KernelThread()
+{
+    stopThread(1000);
+}
+
+void LinearPhaseEngine::KernelThread::add(LinearPhaseEngine* engine)
+{
+    const juce::ScopedLock sl(lock);
+    engines.addIfNotAlreadyThere(engine);
+}
+
+void LinearPhaseEngine::KernelThread::remove(LinearPhaseEngine* engine)
+{
+    const juce::ScopedLock sl(lock);
+    engines.removeFirstMatchingValue(engine);
+}
+
+void LinearPhaseEngine::KernelThread::run()
+{
+    while (! threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            for (auto* engine : engines)
+                engine->designIfChanged();
+        }
+        wait(pollIntervalMs);
+    }
+}
+
+//==============================================================================
+LinearPhaseEngine::LinearPhaseEngine(const ChainParameters& p) : parameters(p)
+{
+}
+
+LinearPhaseEngine::~LinearPhaseEngine()
+{
+    release();
+}
+
+void LinearPhaseEngine::prepare(double sampleRate, int numChannels)
+{
+    release();
+
+    for (auto& kernel : kernels)
+        kernel.spectra.assign((size_t) maxSpectrumFloats, 0.f);
+
+    channelStates.resize((size_t) numChannels);
+    for (auto& state : channelStates)
+    {
+        state.input.assign(2 * (size_t) maxBlockSize, 0.f);
+        state.output.assign((size_t) maxBlockSize, 0.f);
+        state.delayLine.assign((size_t) maxSpectrumFloats, 0.f);
+    }
+
+    // Real-only transforms of 2 * blockSize points need twice that much room
+    fftBuffer.assign(4 * (size_t) maxBlockSize, 0.f);
+    fadeBuffer.assign(4 * (size_t) maxBlockSize, 0.f);
+
+    ffts.clear();
+    for (auto size = minBlockSize; size <= maxBlockSize; size *= 2)
+        ffts.push_back(std::make_unique<juce::dsp::FFT>(log2(2 * size)));
+
+    {
+        const juce::ScopedLock sl(designLock);
+        hostSampleRate = sampleRate;
+        designedVersion = version.load();
+
+        active = 0;
+        previous = 1;
+        back = 2;
+        middle = 3;
+        design(kernels[(size_t) active], parameters.load());
+    }
+
+    reset();
+
+    kernelThread->add(this);
+    registered = true;
+}
+
+void LinearPhaseEngine::release()
+{
+    if (registered)
+    {
+        kernelThread->remove(this);
+        registered = false;
+    }
+
+    // Most of an instance's memory is in here, so none is kept while the mode is off
+    for (auto& kernel : kernels)
+        kernel.spectra = {};
+    channelStates = {};
+    fftBuffer = {};
+    fadeBuffer = {};
+    ffts.clear();
+    fft = nullptr;
+}
+
+void LinearPhaseEngine::designIfChanged()
+{
+    const juce::ScopedLock sl(designLock);
+    const auto newVersion = version.load();
+    if (newVersion == designedVersion)
+        return;
+    designedVersion = newVersion;
+
+    // Switching the mode on bumps the version too, so nothing is lost by waiting
+    const auto settings = parameters.load();
+    if (! settings.linearPhase)
+        return;
+
+    design(kernels[(size_t) back], settings);
+    back = middle.exchange(back | newKernelFlag, std::memory_order_acq_rel) & indexMask;
+}
+
+void LinearPhaseEngine::design(Kernel& kernel, const ChainSettings& settings) const
+{
+    const auto length = juce::jlimit(minLength, maxLength, settings.linearPhaseLength);
+    const auto partitionSize = juce::jlimit(minBlockSize, juce::jmin(maxBlockSize, length), settings.linearPhaseBlockSize);
+    const auto coefficients = makeChainCoefficients(settings, hostSampleRate);
+
+    // The magnitude with a delay of half the length, e^(-j pi k) = (-1)^k, so the inverse
+    // transform comes out symmetric around the middle tap
+    std::vector<float> impulse(2 * (size_t) length, 0.f);
+    for (int k = 0; k <= length / 2; ++k)
+    {
+        const auto magnitude = (float) getMagnitudeForFrequency(coefficients, k * hostSampleRate / length);
+        impulse[2 * (size_t) k] = (k & 1) != 0 ? -magnitude : magnitude;
+    }
+
+    juce::dsp::FFT(log2(length)).performRealOnlyInverseTransform(impulse.data());
+
+    // Sampling the response only pins it down at the grid points; the window keeps what
+    // happens in between from wrapping around the ends
+    for (int n = 0; n < length; ++n)
+        impulse[(size_t) n] *= 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float) n / (float) length);
+
+    juce::dsp::FFT partitionFft(log2(2 * partitionSize));
+    std::vector<float> partition(4 * (size_t) partitionSize);
+    const auto floatsPerPartition = 2 * (partitionSize + 1);
+
+    kernel.blockSize = partitionSize;
+    kernel.numPartitions = length / partitionSize;
+
+    for (int p = 0; p < kernel.numPartitions; ++p)
+    {
+        std::fill(partition.begin(), partition.end(), 0.f);
+        std::copy_n(impulse.data() + p * partitionSize, partitionSize, partition.data());
+        partitionFft.performRealOnlyForwardTransform(partition.data(), true);
+        std::copy_n(partition.data(), floatsPerPartition, kernel.spectra.data() + p * floatsPerPartition);
+    }
+}
+
+//==============================================================================
+void LinearPhaseEngine::reset() noexcept
+{
+    const auto& kernel = kernels[(size_t) active];
+    blockSize = kernel.blockSize;
+    numPartitions = kernel.numPartitions;
+    fft = ffts[(size_t) (log2(blockSize) - log2(minBlockSize))].get();
+
+    for (auto& state : channelStates)
+    {
+        std::fill(state.input.begin(), state.input.end(), 0.f);
+        std::fill(state.output.begin(), state.output.end(), 0.f);
+        std::fill(state.delayLine.begin(), state.delayLine.end(), 0.f);
+    }
+
+    numBuffered = 0;
+    delayLineIndex = 0;
+    fadeRemaining = 0;
+}
+
+void LinearPhaseEngine::takeNewKernel() noexcept
+{
+    // Both slots stay in use until a crossfade is over
+    if (fadeRemaining > 0 || (middle.load(std::memory_order_relaxed) & newKernelFlag) == 0)
+        return;
+
+    const auto taken = middle.exchange(previous, std::memory_order_acq_rel) & indexMask;
+    previous = active;
+    active = taken;
+
+    const auto& kernel = kernels[(size_t) active];
+    if (kernel.blockSize != blockSize || kernel.numPartitions != numPartitions)
+    {
+        reset();
+        return;
+    }
+
+    fadeLength = juce::jmax(1, (int) std::ceil(crossfadeSeconds * hostSampleRate / blockSize));
+    fadeRemaining = fadeLength;
+}
+
+template <typename SampleType>
+void LinearPhaseEngine::process(SampleType* const* channels, int numChannels, int numSamples) noexcept
+{
+    jassert(fft != nullptr);
+    numChannels = juce::jmin(numChannels, (int) channelStates.size());
+
+    if (numBuffered == 0)
+        takeNewKernel();
+
+    for (int start = 0; start < numSamples;)
+    {
+        const auto num = juce::jmin(numSamples - start, blockSize - numBuffered);
+
+        // The input goes into the newest half of the window before the output, one
+        // partition old, overwrites it
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& state = channelStates[(size_t) ch];
+            auto* data = channels[ch] + start;
+            auto* input = state.input.data() + blockSize + numBuffered;
+            const auto* output = state.output.data() + numBuffered;
+
+            for (int i = 0; i < num; ++i)
+                input[i] = (float) data[i];
+            for (int i = 0; i < num; ++i)
+                data[i] = (SampleType) output[i];
+        }
+
+        start += num;
+        numBuffered += num;
+
+        if (numBuffered == blockSize)
+        {
+            processPartition(numChannels);
+            numBuffered = 0;
+            takeNewKernel();
+        }
+    }
+}
+
+void LinearPhaseEngine::processPartition(int numChannels) noexcept
+{
+    const auto floatsPerPartition = 2 * (blockSize + 1);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& state = channelStates[(size_t) ch];
+
+        // Overlap-save: transform the last two partitions of input, and slide them along
+        std::copy_n(state.input.data(), 2 * blockSize, fftBuffer.data());
+        std::fill(fftBuffer.begin() + 2 * blockSize, fftBuffer.begin() + 4 * blockSize, 0.f);
+        fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+        std::copy_n(fftBuffer.data(), floatsPerPartition, state.delayLine.data() + delayLineIndex * floatsPerPartition);
+        std::copy_n(state.input.data() + blockSize, blockSize, state.input.data());
+
+        // Only the second half of the circular convolution is free of wrap-around
+        convolve(kernels[(size_t) active], state, fftBuffer.data());
+        const auto* wet = fftBuffer.data() + blockSize;
+
+        if (fadeRemaining > 0)
+        {
+            convolve(kernels[(size_t) previous], state, fadeBuffer.data());
+            const auto* old = fadeBuffer.data() + blockSize;
+            const auto fadeStart = (float) (fadeLength - fadeRemaining) * (float) blockSize;
+            const auto fadeScale = 1.f / ((float) fadeLength * (float) blockSize);
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const auto gain = (fadeStart + (float) (i + 1)) * fadeScale;
+                state.output[(size_t) i] = old[i] + gain * (wet[i] - old[i]);
+            }
+        }
+        else
+        {
+            std::copy_n(wet, blockSize, state.output.data());
+        }
+    }
+
+    delayLineIndex = (delayLineIndex + 1) % numPartitions;
+
+    if (fadeRemaining > 0)
+        --fadeRemaining;
+}
+
+void LinearPhaseEngine::convolve(const Kernel& kernel, const ChannelState& state, float* dest) const noexcept
+{
+    const auto numBins = blockSize + 1;
+    const auto floatsPerPartition = 2 * numBins;
+    std::fill(dest, dest + 4 * blockSize, 0.f);
+
+    // The newest input spectrum meets the first partition of the kernel, the oldest the last
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        const auto slot = (delayLineIndex + numPartitions - p) % numPartitions;
+        const auto* x = state.delayLine.data() + slot * floatsPerPartition;
+        const auto* h = kernel.spectra.data() + p * floatsPerPartition;
+
+        for (int k = 0; k < floatsPerPartition; k += 2)
+        {
+            dest[k]     += x[k] * h[k]     - x[k + 1] * h[k + 1];
+            dest[k + 1] += x[k] * h[k + 1] + x[k + 1] * h[k];
+        }
+    }
+
+    fft->performRealOnlyInverseTransform(dest);
+}
+
+template void LinearPhaseEngine::process<float>(float* const*, int, int) noexcept;
+template void LinearPhaseEngine::process<double>(double* const*, int, int) noexcept;
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEngine.h
+    Linear phase alternative to the IIR cascade: an FIR with the chain's
+    magnitude response, run through uniformly partitioned FFT convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterChain.h"
+
+// A shared background thread samples the magnitude response of the current settings (the
+// same curve the editor draws) on a linearPhaseLength point grid, turns it into a
+// symmetric FIR delayed by half its length, and splits that into linearPhaseBlockSize
+// partitions, each transformed once. The audio thread collects one partition of input,
+// transforms it into a frequency domain delay line, and multiplies that against the
+// kernel's partitions, so the cost per sample grows with length / blockSize rather than
+// with the length itself.
+//
+// Kernels are handed over through four preallocated slots, two of which the audio thread
+// holds while it crossfades from the old kernel to the new one. A kernel with a different
+// length or block size changes the latency, so it is switched to without a fade.
+class LinearPhaseEngine
+{
+public:
+    static constexpr int minLength = 2048, maxLength = 16384;
+    static constexpr int minBlockSize = 128, maxBlockSize = 2048;
+
+    explicit LinearPhaseEngine(const ChainParameters& parameters);
+    ~LinearPhaseEngine();
+
+    // Message thread, with the audio thread not using the engine. Allocates for the
+    // largest length and block size, designs the current settings synchronously and from
+    // then on lets the shared kernel thread pick up parameter changes. release() frees
+    // everything again.
+    void prepare(double sampleRate, int numChannels);
+    void release();
+
+    // Wait-free; safe to call from any thread, including the audio thread.
+    void parametersChanged() noexcept { version.fetch_add(1); }
+
+    // Audio thread
+    void reset() noexcept;
+
+    template <typename SampleType>
+    void process(SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+    // Audio thread. Samples until silent input has made its way out: the whole FIR, plus
+    // the partition it waits to fill.
+    int getTailSamples() const noexcept   { return (numPartitions + 1) * blockSize; }
+
+    // Half the FIR, plus one partition of input buffering
+    static int getLatencySamples(int length, int blockSize) noexcept   { return length / 2 + blockSize; }
+
+    // Audio thread. The latency of the kernel the audio is running through, which only
+    // changes once a kernel with a new length or block size has been switched to.
+    int getCurrentLatencySamples() const noexcept   { return getLatencySamples(numPartitions * blockSize, blockSize); }
+
+    //==============================================================================
+    // One thread per process serves every engine, polling their versions.
+    class KernelThread : public juce::Thread
+    {
+    public:
+        KernelThread();
+        ~KernelThread() override;
+
+        void add(LinearPhaseEngine*);
+        void remove(LinearPhaseEngine*);
+        void run() override;
+
+    private:
+        juce::CriticalSection lock;
+        juce::Array<LinearPhaseEngine*> engines;
+    };
+
+private:
+    static constexpr double crossfadeSeconds = 0.05;
+
+    // Each partition keeps blockSize + 1 bins, stored as interleaved real / imaginary pairs
+    static constexpr int maxSpectrumFloats = 2 * (maxLength + maxLength / minBlockSize);
+
+    struct Kernel
+    {
+        int blockSize { 0 }, numPartitions { 0 };
+        std::vector<float> spectra;
+    };
+
+    struct ChannelState
+    {
+        std::vector<float> input, output;
+        std::vector<float> delayLine;
+    };
+
+    void designIfChanged();
+    void design(Kernel& kernel, const ChainSettings& settings) const;
+    void takeNewKernel() noexcept;
+    void processPartition(int numChannels) noexcept;
+    void convolve(const Kernel& kernel, const ChannelState& state, float* dest) const noexcept;
+
+    const ChainParameters& parameters;
+    std::atomic<juce::uint32> version { 1 };
+    juce::uint32 designedVersion { 0 };
+    double hostSampleRate { 0 };
+    juce::CriticalSection designLock;
+
+    // Slot ownership: the audio thread holds active and previous, the kernel thread holds
+    // back, and middle is passed between them, flagged when it carries a new kernel.
+    static constexpr int newKernelFlag = 4, indexMask = 3;
+    std::array<Kernel, 4> kernels;
+    std::atomic<int> middle { 3 };
+    int back { 2 }, active { 0 }, previous { 1 };
+
+    // Only touched by the audio thread
+    std::vector<ChannelState> channelStates;
+    std::vector<std::unique_ptr<juce::dsp::FFT>> ffts;      // one per block size
+    std::vector<float> fftBuffer, fadeBuffer;
+    int blockSize { 0 }, numPartitions { 0 };
+    juce::dsp::FFT* fft = nullptr;
+    int numBuffered { 0 }, delayLineIndex { 0 };
+    int fadeLength { 0 }, fadeRemaining { 0 };
+
+    juce::SharedResourcePointer<KernelThread> kernelThread;
+    bool registered { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinearPhaseEngine)
+};
@@ -1,101 +1,150 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin editor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "PluginProcessor.h"
-
-struct LookAndFeel: juce::LookAndFeel_V4
-{
-    void drawRotarySlider (juce::Graphics&,
-                           int x, int y, int width, int height,
-                           float sliderPosProportional,
-                           float rotaryStartAngle,
-                           float rotaryEndAngle,
-                           juce::Slider&) override;
-};
-
-struct CustomRotarySlider : juce::Slider
-{
-    CustomRotarySlider(juce::RangedAudioParameter& rap, const juce::String& unitSuffix) : juce::Slider(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag,
-                                    juce::Slider::TextEntryBoxPosition::NoTextBox),
-    param(&rap),
-    suffix(unitSuffix)
-    {
-        setLookAndFeel(&lnf);
-    }
-    
-    ~CustomRotarySlider()
-    {
-        setLookAndFeel(nullptr);
-    }
-    struct LabelPos
-    {
-        float pos;
-        juce::String label;
-    };
-    juce::Array<LabelPos> labels;
-    
-    LookAndFeel lnf;
-    void paint (juce::Graphics&) override;
-    juce::Rectangle<int> getSliderBounds() const;
-    int getTextHeight() const{return 14;}
-    juce::String getDisplayString() const;
-private:
-    juce::RangedAudioParameter * param;
-    juce::String suffix;
-    
-};
-
-struct ResponseCurveComponent: juce::Component,
-juce::AudioProcessorParameter::Listener,
-juce::Timer
-{
-public:
-    ResponseCurveComponent(First_EQAudioProcessor&);
-    ~ResponseCurveComponent();
-    void parameterValueChanged (int parameterIndex, float newValue) override;
-    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
-    void timerCallback () override;
-    void paint (juce::Graphics&) override;
-private:
-    juce::Atomic<bool> parametersChanged { false };
-    First_EQAudioProcessor& audioProcessor;
-    MonoChain monoChain;
-};
-
-//==============================================================================
-/**
-*/
-class First_EQAudioProcessorEditor  : public juce::AudioProcessorEditor,
-juce::Button::Listener
-{
-public:
-    First_EQAudioProcessorEditor (First_EQAudioProcessor&);
-    ~First_EQAudioProcessorEditor() override;
-
-    //==============================================================================
-    void resized() override;
-    void buttonClicked (juce::Button* button) override;
-    void buttonStateChanged (juce::Button* button) override {}
-private:
-    // This reference is provided as a quick way for your editor to
-    // access the processor object that created it.
-    First_EQAudioProcessor& audioProcessor;
-    CustomRotarySlider peakFreqSlider, peakGainSlider, peakQualitySlider, lowCutFreqSlider, highCutFreqSlider, lowCutSlopeSlider, highCutSlopeSlider;
-    ResponseCurveComponent responseCurveComponent;
-    juce::TextButton resetBtn {"Reset"};
-    std::vector<juce::Component*> getComps();
-    using APVTS = juce::AudioProcessorValueTreeState;
-    using Attachment = APVTS::SliderAttachment;
-    Attachment peakFreqAttachment, peakGainAttachment, peakQualityAttachment, lowCutFreqAttachment, highCutFreqAttachment, lowCutSlopeAttachment, highCutSlopeAttachment;
-
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (First_EQAudioProcessorEditor)
-};
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "ResponseCurveCalculator.h"
+#include "SpectrumAnalyzer.h"
+
+struct LookAndFeel: juce::LookAndFeel_V4
+{
+    void drawRotarySlider (juce::Graphics&,
+                           int x, int y, int width, int height,
+                           float sliderPosProportional,
+                           float rotaryStartAngle,
+                           float rotaryEndAngle,
+                           juce::Slider&) override;
+};
+
+struct CustomRotarySlider : juce::Slider
+{
+    CustomRotarySlider(juce::RangedAudioParameter& rap, const juce::String& unitSuffix) : juce::Slider(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag,
+                                    juce::Slider::TextEntryBoxPosition::NoTextBox),
+    param(&rap),
+    suffix(unitSuffix)
+    {
+        setLookAndFeel(&lnf);
+    }
+    
+    ~CustomRotarySlider()
+    {
+        setLookAndFeel(nullptr);
+    }
+    struct LabelPos
+    {
+        float pos;
+        juce::String label;
+    };
+    juce::Array<LabelPos> labels;
+    
+    LookAndFeel lnf;
+    void paint (juce::Graphics&) override;
+    juce::Rectangle<int> getSliderBounds() const;
+    int getTextHeight() const{return 14;}
+    juce::String getDisplayString() const;
+    void setParameter(juce::RangedAudioParameter& rap) { param = &rap; repaint(); }
+private:
+    juce::RangedAudioParameter * param;
+    juce::String suffix;
+    
+};
+
+struct ResponseCurveComponent: juce::Component,
+juce::AudioProcessorParameter::Listener,
+juce::Timer
+{
+public:
+    ResponseCurveComponent(First_EQAudioProcessor&);
+    ~ResponseCurveComponent();
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
+    void timerCallback () override;
+    void paint (juce::Graphics&) override;
+    void resized() override;
+private:
+    juce::Atomic<bool> parametersChanged { true };
+    First_EQAudioProcessor& audioProcessor;
+    ChainSettings chainSettings;
+    ResponseCurveCalculator curveCalculator;
+    SpectrumAnalyzer analyzer { audioProcessor.preAnalyzerFifo, audioProcessor.postAnalyzerFifo };
+
+    // Fill, grid and frame, drawn at the context's physical scale and redrawn only when
+    // the size or that scale changes
+    juce::Image background;
+    float backgroundScale { 0 };
+    void renderBackground(float scale);
+};
+
+// The processor's load telemetry, drawn in a corner of the response curve while the
+// editor's Load button is on. Rates are worked out from the change between polls;
+// clicking copies the full dump to the clipboard.
+struct LoadOverlay: juce::Component,
+juce::Timer
+{
+public:
+    LoadOverlay(const DspLoadMonitor&);
+    void timerCallback() override;
+    void visibilityChanged() override;
+    void paint(juce::Graphics&) override;
+    void mouseUp(const juce::MouseEvent&) override;
+private:
+    static constexpr int refreshRateHz = 4;
+    const DspLoadMonitor& monitor;
+    DspLoadMonitor::Snapshot last;
+    juce::uint32 lastMillis { 0 };
+    juce::StringArray lines;
+};
+
+//==============================================================================
+/**
+*/
+class First_EQAudioProcessorEditor  : public juce::AudioProcessorEditor,
+juce::Button::Listener, juce::ChangeListener
+{
+public:
+    First_EQAudioProcessorEditor (First_EQAudioProcessor&);
+    ~First_EQAudioProcessorEditor() override;
+
+    //==============================================================================
+    void resized() override;
+    void buttonClicked (juce::Button* button) override;
+    void buttonStateChanged (juce::Button* button) override {}
+    void changeListenerCallback (juce::ChangeBroadcaster* source) override;
+private:
+    // This reference is provided as a quick way for your editor to
+    // access the processor object that created it.
+    First_EQAudioProcessor& audioProcessor;
+    CustomRotarySlider peakFreqSlider, peakGainSlider, peakQualitySlider, lowCutFreqSlider, highCutFreqSlider, lowCutSlopeSlider, highCutSlopeSlider;
+    ResponseCurveComponent responseCurveComponent;
+    juce::TextButton resetBtn {"Reset"};
+    juce::ComboBox bandSelector, bandTypeBox;
+    juce::ToggleButton bandEnabledButton {"On"};
+    juce::ToggleButton loadButton {"Load"};
+    juce::TextButton abButton {"A"};
+    juce::ComboBox presetBox;
+    juce::TextButton storeButton {"Store"};
+    LoadOverlay loadOverlay;
+    std::vector<juce::Component*> getComps();
+    using APVTS = juce::AudioProcessorValueTreeState;
+    using Attachment = APVTS::SliderAttachment;
+    Attachment lowCutFreqAttachment, highCutFreqAttachment, lowCutSlopeAttachment, highCutSlopeAttachment;
+
+    // The peak sliders, type box and on button edit whichever band is selected
+    std::unique_ptr<Attachment> peakFreqAttachment, peakGainAttachment, peakQualityAttachment;
+    std::unique_ptr<APVTS::ComboBoxAttachment> bandTypeAttachment;
+    std::unique_ptr<APVTS::ButtonAttachment> bandEnabledAttachment;
+    void selectBand(int band);
+
+    // Follows the processor's preset bank, whether the change came from here or the host
+    void updatePresetControls();
+
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (First_EQAudioProcessorEditor)
+};
@@ -1,302 +1,787 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-First_EQAudioProcessor::First_EQAudioProcessor()
-#ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
-#endif
-{
-}
-
-First_EQAudioProcessor::~First_EQAudioProcessor()
-{
-}
-
-//==============================================================================
-const juce::String First_EQAudioProcessor::getName() const
-{
-    return JucePlugin_Name;
-}
-
-bool First_EQAudioProcessor::acceptsMidi() const
-{
-   #if JucePlugin_WantsMidiInput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool First_EQAudioProcessor::producesMidi() const
-{
-   #if JucePlugin_ProducesMidiOutput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool First_EQAudioProcessor::isMidiEffect() const
-{
-   #if JucePlugin_IsMidiEffect
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-double First_EQAudioProcessor::getTailLengthSeconds() const
-{
-    return 0.0;
-}
-
-int First_EQAudioProcessor::getNumPrograms()
-{
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
-}
-
-int First_EQAudioProcessor::getCurrentProgram()
-{
-    return 0;
-}
-
-void First_EQAudioProcessor::setCurrentProgram (int index)
-{
-}
-
-const juce::String First_EQAudioProcessor::getProgramName (int index)
-{
-    return {};
-}
-
-void First_EQAudioProcessor::changeProgramName (int index, const juce::String& newName)
-{
-}
-
-//==============================================================================
-void First_EQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
-{
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
-    juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
-    updateFilter();
-}
-
-void First_EQAudioProcessor::releaseResources()
-{
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
-}
-
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool First_EQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
-{
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-   #endif
-
-    return true;
-  #endif
-}
-#endif
-
-void First_EQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
-{
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-    // In case we have more outputs than inputs, this code clears any output
-    // channels that didn't contain input data, (because these aren't
-    // guaranteed to be empty - they may contain garbage).
-    // This is here to avoid people getting screaming feedback
-    // when they first compile a plugin, but obviously you don't need to keep
-    // this code if your algorithm always overwrites all the output channels.
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
-
-    updateFilter();
-    
-    juce::dsp::AudioBlock<float> block(buffer);
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-    
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
-    
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
-    {
-        auto* channelData = buffer.getWritePointer (channel);
-
-        // ..do something to the data...
-    }
-}
-
-//==============================================================================
-bool First_EQAudioProcessor::hasEditor() const
-{
-    return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor* First_EQAudioProcessor::createEditor()
-{
-    return new First_EQAudioProcessorEditor (*this);
-//    return new juce::GenericAudioProcessorEditor(*this);
-}
-
-//==============================================================================
-void First_EQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
-{
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
-}
-
-void First_EQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
-{
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-    auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
-    if(tree.isValid())
-    {
-        apvts.replaceState(tree);
-        updateFilter();
-    }
-}
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
-{
-    ChainSettings settings;
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
-    return settings;
-}
-
-Coefficients  makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainDecibels));
-}
-
-void First_EQAudioProcessor::updatePeakFilter(const ChainSettings& chainSettings)
-{
-//    auto peakCoefficient = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(), chainSettings.peakFreq, chainSettings.peakQuality, juce::Decibels::decibelsToGain(chainSettings.peakGainDecibels));
-//
-    auto peakCoefficient = makePeakFilter(chainSettings, getSampleRate());
-//    *leftChain.get<ChainPositions::Peak>().coefficients = *peakCoefficient;
-//    *rightChain.get<ChainPositions::Peak>().coefficients = *peakCoefficient;
-    updateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficient);
-    updateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficient);
-}
-
-void updateCoefficients(Coefficients& old, const Coefficients& replacement)
-{
-    *old = *replacement;
-}
-
-void First_EQAudioProcessor::updateHighCutFilter(const ChainSettings &chainSettings) {
-    auto highCutCoefficient = makeHighCutFilter(chainSettings, getSampleRate());
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    updateCutFilter(leftHighCut, highCutCoefficient, chainSettings.highCutSlope);
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
-    updateCutFilter(rightHighCut, highCutCoefficient, chainSettings.highCutSlope);
-}
-
-void First_EQAudioProcessor::updateLowCutFilter(const ChainSettings &chainSettings) {
-    auto lowCutCoefficient  = makeLowCutFilter(chainSettings, getSampleRate());
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    updateCutFilter(leftLowCut, lowCutCoefficient, chainSettings.lowCutSlope);
-
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
-    updateCutFilter(rightLowCut, lowCutCoefficient, chainSettings.lowCutSlope);
-}
-
-void First_EQAudioProcessor::updateFilter() {
-    auto chainSettings = getChainSettings(apvts);
-    updateLowCutFilter(chainSettings);
-    updateHighCutFilter(chainSettings);
-    updatePeakFilter(chainSettings);
-}
-
-juce::AudioProcessorValueTreeState::ParameterLayout First_EQAudioProcessor::createParameterLayout()
-{
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut Freq", "LowCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq", "HighCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq", "Peak Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.5f), 750.f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain", "Peak Gain", juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality", "Peak Quality", juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
-    juce::StringArray stringArray;
-    for (int i = 0; i < 4; ++i) {
-        juce::String str;
-        str << (12 + i * 12);
-        str << " dB/Oct";
-        stringArray.add(str);
-        
-    }
-    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", stringArray, 0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
-    return layout;
-}
-
-void First_EQAudioProcessor::resetAllParam()
-{
-    
-}
-
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
-{
-    return new First_EQAudioProcessor();
-}
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+First_EQAudioProcessor::First_EQAudioProcessor()
+#ifndef JucePlugin_PreferredChannelConfigurations
+     : AudioProcessor (BusesProperties()
+                     #if ! JucePlugin_IsMidiEffect
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                      #endif
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                     #endif
+                       )
+#endif
+{
+    for (auto* param : getParameters())
+        param->addListener(this);
+
+    startTimer(settingsPollIntervalMs);
+}
+
+First_EQAudioProcessor::~First_EQAudioProcessor()
+{
+    stopTimer();
+    releaseChannelPool();
+    for (auto* param : getParameters())
+        param->removeListener(this);
+}
+
+//==============================================================================
+const juce::String First_EQAudioProcessor::getName() const
+{
+    return JucePlugin_Name;
+}
+
+bool First_EQAudioProcessor::acceptsMidi() const
+{
+   #if JucePlugin_WantsMidiInput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool First_EQAudioProcessor::producesMidi() const
+{
+   #if JucePlugin_ProducesMidiOutput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool First_EQAudioProcessor::isMidiEffect() const
+{
+   #if JucePlugin_IsMidiEffect
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+double First_EQAudioProcessor::getTailLengthSeconds() const
+{
+    return tailLengthSeconds.load();
+}
+
+int First_EQAudioProcessor::getNumPrograms()
+{
+    return presetBank.getNumPresets();
+}
+
+int First_EQAudioProcessor::getCurrentProgram()
+{
+    return presetBank.getCurrentIndex();
+}
+
+void First_EQAudioProcessor::setCurrentProgram (int index)
+{
+    presetBank.recall(index);
+}
+
+const juce::String First_EQAudioProcessor::getProgramName (int index)
+{
+    return presetBank.getName(index);
+}
+
+void First_EQAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+    presetBank.rename(index, newName);
+}
+
+//==============================================================================
+void First_EQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    // Use this method as the place to do any pre-playback
+    // initialisation that you need..
+    // The cascade only ever sees the smoother's sub-blocks, so that is all the
+    // oversampling stages need room for
+    const auto numChannels = juce::jlimit(1, maxChannels, getTotalNumInputChannels());
+    const auto maxChainBlockSize = ChainOversampler<float>::maxFactor * ChainSmoother::subBlockSize;
+    if (isUsingDoublePrecision())
+    {
+        doubleBatches.allocate(numChannels);
+        floatBatches = {};
+        doubleOversampler.prepare(numChannels, BatchChain<double>::numLanes, ChainSmoother::subBlockSize);
+        floatOversampler.release();
+        doubleCrossfade.outgoing.allocate(numChannels);
+        doubleCrossfade.buffer.setSize(numChannels, maxChainBlockSize);
+        floatCrossfade = {};
+    }
+    else
+    {
+        floatBatches.allocate(numChannels);
+        doubleBatches = {};
+        floatOversampler.prepare(numChannels, BatchChain<float>::numLanes, ChainSmoother::subBlockSize);
+        doubleOversampler.release();
+        floatCrossfade.outgoing.allocate(numChannels);
+        floatCrossfade.buffer.setSize(numChannels, maxChainBlockSize);
+        doubleCrossfade = {};
+    }
+    fadePosition = 1;
+    deferredBands = 0;
+    activeOversamplingFactor = 1;
+    activeLinearPhaseOversampling = false;
+
+    // A block that doesn't start on the grid touches one sub-block more than it fills
+    const auto numSubBlocks = juce::jlimit(2, maxPlannedSubBlocks, samplesPerBlock / ChainSmoother::subBlockSize + 2);
+    plannedSubBlocks.resize((size_t) numSubBlocks);
+    plannedCoefficients.resize((size_t) numSubBlocks);
+    numPlannedSubBlocks = numPlannedCoefficients = 0;
+
+    loadMonitor.prepare(sampleRate);
+    smoother.prepare(sampleRate);
+    designer.prepare(sampleRate);
+    preparedChannels = numChannels;
+    if (chainParameters.eqMode->getIndex() == 1)
+    {
+        linearPhaseEngine.prepare(sampleRate, numChannels);
+        linearPhaseReady = true;
+    }
+    else
+    {
+        linearPhaseEngine.release();
+        linearPhaseReady = false;
+    }
+    activeLinearPhase = linearPhaseReady;
+
+    channelPoolReady = false;
+    updateChannelPool();
+
+    silentSamples = 0;
+    idle = false;
+    updateFilter();
+    samplesUntilCoefficientUpdate = 0;
+    publishLatency();
+    updateLatency();
+}
+
+void First_EQAudioProcessor::releaseResources()
+{
+    // When playback stops, you can use this as an opportunity to free up any
+    // spare memory, etc.
+    designer.release();
+    linearPhaseEngine.release();
+    linearPhaseReady = false;
+    releaseChannelPool();
+    preparedChannels = 0;
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool First_EQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+  #if JucePlugin_IsMidiEffect
+    juce::ignoreUnused (layouts);
+    return true;
+  #else
+    // Any layout works as long as it fits into the channel batches, which covers
+    // everything from mono up to 7th order ambisonics and 64 channel immersive beds.
+    const auto numChannels = layouts.getMainOutputChannelSet().size();
+    if (numChannels < 1 || numChannels > maxChannels)
+        return false;
+
+    // This checks if the input layout matches the output layout
+   #if ! JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+   #endif
+
+    return true;
+  #endif
+}
+#endif
+
+void First_EQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer);
+}
+
+void First_EQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer);
+}
+
+template <typename SampleType>
+void First_EQAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer)
+{
+    juce::ScopedNoDenormals noDenormals;
+    const DspLoadMonitor::ScopedBlock loadTimer(loadMonitor, buffer.getNumSamples());
+    auto totalNumInputChannels  = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    // In case we have more outputs than inputs, this code clears any output
+    // channels that didn't contain input data, (because these aren't
+    // guaranteed to be empty - they may contain garbage).
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear (i, 0, buffer.getNumSamples());
+
+    updateFilter();
+    updateMode();
+    publishLatency();
+    
+    const auto numChannels = juce::jmin(totalNumInputChannels, buffer.getNumChannels(), maxChannels);
+    const auto numSamples = buffer.getNumSamples();
+    auto* const* channelData = buffer.getArrayOfWritePointers();
+    const auto analyzerOpen = numChannels > 0 && preAnalyzerFifo.isEnabled() && postAnalyzerFifo.isEnabled();
+
+    if (analyzerOpen)
+        preAnalyzerFifo.push(channelData, numChannels, numSamples);
+
+    const auto inputSilent = buffer.getMagnitude(0, numSamples) < silenceThreshold;
+    if (! inputSilent)
+    {
+        silentSamples = 0;
+        idle = false;
+    }
+    else if (idle)
+    {
+        // Nothing left ringing, so silence in is silence out
+        buffer.clear();
+        if (analyzerOpen)
+            postAnalyzerFifo.push(channelData, numChannels, numSamples);
+        return;
+    }
+
+    if (activeLinearPhase)
+    {
+        linearPhaseEngine.process(channelData, numChannels, numSamples);
+    }
+    else
+    {
+        for (int start = 0; start < numSamples;)
+        {
+            const auto end = planSubBlocks<SampleType>(start, numSamples);
+            processBatches(channelData, numChannels);
+            start = end;
+        }
+    }
+
+    if (inputSilent)
+    {
+        silentSamples += numSamples;
+        const auto hangover = activeLinearPhase ? linearPhaseEngine.getTailSamples() : idleHangoverSamples;
+        if (silentSamples >= hangover && buffer.getMagnitude(0, numSamples) < silenceThreshold)
+        {
+            // Whatever the filters still hold is below the threshold, so starting from a
+            // clean state when signal returns can't click
+            resetFilters();
+            idle = true;
+        }
+    }
+
+    if (analyzerOpen)
+        postAnalyzerFifo.push(channelData, numChannels, numSamples);
+}
+
+template <typename SampleType>
+int First_EQAudioProcessor::planSubBlocks(int start, int numSamples)
+{
+    numPlannedSubBlocks = 0;
+    numPlannedCoefficients = 0;
+
+    // Nothing to plan with before prepareToPlay()
+    if (plannedSubBlocks.empty())
+        return numSamples;
+
+    // The chains and the fade run at the oversampled rate
+    const auto chainSamplesPerSample = getOversampler<SampleType>().isActive() ? activeOversamplingFactor : 1;
+
+    while (start < numSamples && numPlannedSubBlocks < (int) plannedSubBlocks.size())
+    {
+        auto& subBlock = plannedSubBlocks[(size_t) numPlannedSubBlocks++];
+        subBlock.changedBands = 0;
+        subBlock.startsFade = false;
+
+        if (samplesUntilCoefficientUpdate == 0)
+        {
+            const auto changed = smoother.advance();
+            deferredBands |= smoother.getSwitchedBands();
+
+            if (deferredBands != 0 && fadePosition >= 1)
+            {
+                subBlock.startsFade = startCrossfade<SampleType>();
+                subBlock.changedBands = changed | deferredBands;
+                deferredBands = 0;
+            }
+            else
+            {
+                subBlock.changedBands = changed & ~deferredBands;
+            }
+
+            if (subBlock.changedBands != 0)
+            {
+                loadMonitor.addRedesigns(juce::countNumberOfBits((juce::uint32) subBlock.changedBands));
+                subBlock.coefficientsIndex = numPlannedCoefficients;
+                plannedCoefficients[(size_t) numPlannedCoefficients++] = smoother.getCurrent();
+            }
+            samplesUntilCoefficientUpdate = ChainSmoother::subBlockSize;
+        }
+
+        subBlock.start = start;
+        subBlock.numSamples = juce::jmin(numSamples - start, samplesUntilCoefficientUpdate);
+        subBlock.fadePosition = fadePosition;
+        subBlock.fadeIncrement = fadeIncrement;
+        if (fadePosition < 1)
+            fadePosition += subBlock.numSamples * chainSamplesPerSample * fadeIncrement;
+
+        start += subBlock.numSamples;
+        samplesUntilCoefficientUpdate -= subBlock.numSamples;
+    }
+
+    return start;
+}
+
+template <typename SampleType>
+bool First_EQAudioProcessor::startCrossfade()
+{
+    if (getCrossfade<SampleType>().outgoing.size() != getChannelBatches<SampleType>().size())
+        return false;
+
+    // Every batch copies itself into the outgoing chains when it gets to this sub-block.
+    // The chains run at the oversampled rate, which is the rate the smoother designs for.
+    fadePosition = 0;
+    fadeIncrement = 1.0 / (ChainSmoother::rampLengthSeconds * smoother.getCurrent().sampleRate);
+    return true;
+}
+
+template <typename SampleType>
+void First_EQAudioProcessor::processBatches(SampleType* const* channelData, int numChannels)
+{
+    using Batch = BatchChain<SampleType>;
+    const auto numBatches = juce::jmin((int) getChannelBatches<SampleType>().size(),
+                                       (numChannels + Batch::numLanes - 1) / Batch::numLanes);
+
+    // The batches share nothing but the plan, which is only written before they run, so
+    // they can run on any thread in any order
+    channelPoolInUse.store(true);
+    if (chainParameters.parallelChannels->get() && numBatches >= minParallelBatches && channelPoolReady.load())
+    {
+        BatchTask<SampleType> task { *this, channelData, numChannels };
+        channelPool->run(channelJob, &processBatchTask<SampleType>, &task, numBatches);
+        channelPoolInUse.store(false, std::memory_order_release);
+        return;
+    }
+    channelPoolInUse.store(false, std::memory_order_release);
+
+    for (int index = 0; index < numBatches; ++index)
+        processBatch(index, channelData, numChannels);
+}
+
+template <typename SampleType>
+void First_EQAudioProcessor::processBatchTask(void* context, int index)
+{
+    auto& task = *static_cast<BatchTask<SampleType>*>(context);
+    task.processor.processBatch(index, task.channelData, task.numChannels);
+}
+
+template <typename SampleType>
+void First_EQAudioProcessor::processBatch(int index, SampleType* const* channelData, int numChannels) noexcept
+{
+    using Batch = BatchChain<SampleType>;
+    auto& batch = getChannelBatches<SampleType>()[(size_t) index];
+    auto& oversampler = getOversampler<SampleType>();
+    const auto first = index * Batch::numLanes;
+    const auto numInBatch = juce::jmin(Batch::numLanes, numChannels - first);
+
+    for (int i = 0; i < numPlannedSubBlocks; ++i)
+    {
+        const auto& subBlock = plannedSubBlocks[(size_t) i];
+        if (subBlock.startsFade)
+            getCrossfade<SampleType>().outgoing[(size_t) index].copyFrom(batch);
+        if (subBlock.changedBands != 0)
+            applyBandChanges(batch, plannedCoefficients[(size_t) subBlock.coefficientsIndex], subBlock.changedBands);
+
+        juce::dsp::AudioBlock<SampleType> block(channelData + first, (size_t) numInBatch, (size_t) subBlock.start, (size_t) subBlock.numSamples);
+
+        if (oversampler.isActive())
+        {
+            processChain(index, oversampler.processSamplesUp(block, index), subBlock);
+            oversampler.processSamplesDown(block, index);
+        }
+        else
+        {
+            processChain(index, block, subBlock);
+        }
+    }
+}
+
+template <typename SampleType>
+void First_EQAudioProcessor::processChain(int index, juce::dsp::AudioBlock<SampleType> block, const SubBlock& subBlock) noexcept
+{
+    auto& batch = getChannelBatches<SampleType>()[(size_t) index];
+    if (subBlock.fadePosition >= 1)
+    {
+        filterBatch(batch, block);
+        return;
+    }
+
+    auto& crossfade = getCrossfade<SampleType>();
+    const auto numChannels = (int) block.getNumChannels();
+    const auto numSamples = (int) block.getNumSamples();
+    auto* const* outgoingChannels = crossfade.buffer.getArrayOfWritePointers() + index * BatchChain<SampleType>::numLanes;
+    juce::dsp::AudioBlock<SampleType> outgoing(outgoingChannels, (size_t) numChannels, (size_t) numSamples);
+    outgoing.copyFrom(block);
+
+    filterBatch(crossfade.outgoing[(size_t) index], outgoing);
+    filterBatch(batch, block);
+
+    // Both chains see the same input and differ in a single slope, type or on/off state,
+    // so outside that difference their outputs are the same signal. An equal gain fade
+    // keeps that part exactly level, where equal power would swell it by up to 3 dB.
+    const auto start = (SampleType) subBlock.fadePosition;
+    const auto increment = (SampleType) subBlock.fadeIncrement;
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto* data = block.getChannelPointer((size_t) ch);
+        const auto* previous = outgoing.getChannelPointer((size_t) ch);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto inGain = juce::jmin((SampleType) 1, start + (SampleType) i * increment);
+            data[i] = previous[i] + inGain * (data[i] - previous[i]);
+        }
+    }
+}
+
+template <typename SampleType>
+void First_EQAudioProcessor::filterBatch(BatchChain<SampleType>& batch, juce::dsp::AudioBlock<SampleType> block) noexcept
+{
+    using Batch = BatchChain<SampleType>;
+    const auto numChannels = (int) block.getNumChannels();
+    const auto numSamples = (int) block.getNumSamples();
+    SampleType* channels[Batch::numLanes];
+
+    // An oversampled sub-block is longer than the chain's scratch space, so walk it in pieces
+    for (int start = 0; start < numSamples; start += Batch::maxBlockSize)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            channels[ch] = block.getChannelPointer((size_t) ch) + start;
+        batch.process(channels, numChannels, juce::jmin(Batch::maxBlockSize, numSamples - start));
+    }
+}
+
+//==============================================================================
+bool First_EQAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* First_EQAudioProcessor::createEditor()
+{
+    return new First_EQAudioProcessorEditor (*this);
+//    return new juce::GenericAudioProcessorEditor(*this);
+}
+
+//==============================================================================
+void First_EQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    // Every setting lives in a parameter, so the compact binary layout covers the lot.
+    // The preset bank follows it.
+    BinaryState::write(getParameters(), destData);
+
+    juce::MemoryOutputStream out(destData, true);
+    presetBank.writeTo(out);
+}
+
+void First_EQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    // Either way only parameter values change here. The listeners bump the designer's
+    // version, which redesigns off this thread and hands the result to the next block.
+    if (BinaryState::isBinaryState(data, sizeInBytes))
+    {
+        // States saved before the bank was kept end with the parameters, and leave the
+        // bank as it is
+        const auto parametersSize = BinaryState::getSize(data, sizeInBytes);
+        if (BinaryState::read(data, parametersSize, getParameters()))
+            presetBank.readFrom(static_cast<const char*>(data) + parametersSize, sizeInBytes - parametersSize);
+        return;
+    }
+
+    // Sessions saved before the binary format hold the parameter ValueTree
+    auto tree = juce::ValueTree::readFromData(data, (size_t) sizeInBytes);
+    if(tree.isValid() && tree.hasType(apvts.state.getType()))
+    {
+        // replaceState() leaves parameters the tree doesn't mention as they are, so those
+        // go back to their defaults first, the same as BinaryState::read() does
+        for (auto* parameter : getParameters())
+        {
+            auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(parameter);
+            if (withID != nullptr && ! tree.getChildWithProperty("id", withID->paramID).isValid()
+                && parameter->getValue() != parameter->getDefaultValue())
+                parameter->setValueNotifyingHost(parameter->getDefaultValue());
+        }
+
+        apvts.replaceState(tree);
+        designer.parametersChanged();
+    }
+}
+
+void First_EQAudioProcessor::updateFilter() {
+    // All design work for new settings happens on the designer thread; here we only
+    // hand the newest published set to the smoother.
+    auto* chainCoefficients = designer.acquire();
+    if (chainCoefficients == nullptr)
+        return;
+
+    smoother.setTarget(*chainCoefficients);
+
+    // The oversampling mode travels with the coefficients, so the stages are switched at
+    // exactly the point where coefficients designed for the new rate take over
+    const auto& settings = chainCoefficients->settings;
+    if (settings.oversamplingFactor != activeOversamplingFactor
+        || settings.linearPhaseOversampling != activeLinearPhaseOversampling)
+    {
+        floatOversampler.setMode(settings.oversamplingFactor, settings.linearPhaseOversampling);
+        doubleOversampler.setMode(settings.oversamplingFactor, settings.linearPhaseOversampling);
+
+        if (settings.oversamplingFactor != activeOversamplingFactor)
+        {
+            for (auto& batch : floatBatches)
+                batch.reset();
+            for (auto& batch : doubleBatches)
+                batch.reset();
+            fadePosition = 1;
+        }
+
+        activeOversamplingFactor = settings.oversamplingFactor;
+        activeLinearPhaseOversampling = settings.linearPhaseOversampling;
+        samplesUntilCoefficientUpdate = 0;
+    }
+
+    updateTail(*chainCoefficients);
+}
+
+void First_EQAudioProcessor::updateMode()
+{
+    const auto linearPhase = chainParameters.eqMode->getIndex() == 1 && linearPhaseReady.load(std::memory_order_acquire);
+    if (linearPhase == activeLinearPhase)
+        return;
+
+    // The two paths have different latencies, so there is nothing sensible to blend;
+    // whichever one takes over starts from silence
+    activeLinearPhase = linearPhase;
+    resetFilters();
+    updateTail(smoother.getCurrent());
+}
+
+void First_EQAudioProcessor::resetFilters()
+{
+    if (activeLinearPhase)
+    {
+        linearPhaseEngine.reset();
+        return;
+    }
+
+    for (auto& batch : floatBatches)
+        batch.reset();
+    for (auto& batch : doubleBatches)
+        batch.reset();
+    fadePosition = 1;
+
+    // Going through "off" clears whatever the stages still held from before
+    for (auto factor : { 1, activeOversamplingFactor })
+    {
+        floatOversampler.setMode(factor, activeLinearPhaseOversampling);
+        doubleOversampler.setMode(factor, activeLinearPhaseOversampling);
+    }
+    samplesUntilCoefficientUpdate = 0;
+}
+
+void First_EQAudioProcessor::updateTail(const ChainCoefficients& chainCoefficients)
+{
+    const auto sampleRate = getSampleRate();
+    if (sampleRate <= 0)
+        return;
+
+    // The linear phase engine knows its own tail, which publishLatency() passes on
+    if (activeLinearPhase)
+        return;
+
+    const auto oversamplingLatency = isUsingDoublePrecision()
+                                       ? doubleOversampler.getLatencySamples(activeOversamplingFactor, activeLinearPhaseOversampling)
+                                       : floatOversampler.getLatencySamples(activeOversamplingFactor, activeLinearPhaseOversampling);
+
+    // The smoother's ramps have to have finished as well
+    idleHangoverSamples = (int) std::ceil(getTailLengthSeconds(chainCoefficients, idleDecibels) * sampleRate)
+                        + 2 * oversamplingLatency + (int) std::ceil(ChainSmoother::rampLengthSeconds * sampleRate);
+    tailLengthSeconds = getTailLengthSeconds(chainCoefficients, 60.0) + oversamplingLatency / sampleRate;
+}
+
+template <typename SampleType>
+void First_EQAudioProcessor::applyBandChanges(BatchChain<SampleType>& batch, const ChainCoefficients& chainCoefficients, int changedBands) noexcept
+{
+    if (changedBands & LowCutBand)
+        batch.setLowCut(chainCoefficients.lowCut, chainCoefficients.settings.lowCutSlope);
+    if (changedBands & HighCutBand)
+        batch.setHighCut(chainCoefficients.highCut, chainCoefficients.settings.highCutSlope);
+    for (int band = 0; band < maxBands; ++band)
+        if (changedBands & parametricBandMask(band))
+            batch.setBand(band, chainCoefficients.bands[(size_t) band]);
+}
+
+void First_EQAudioProcessor::parameterValueChanged(int parameterIndex, float newValue)
+{
+    designer.parametersChanged();
+    linearPhaseEngine.parametersChanged();
+
+    if (parameterIndex == chainParameters.oversampling->getParameterIndex()
+        || parameterIndex == chainParameters.oversamplingFilter->getParameterIndex()
+        || parameterIndex == chainParameters.eqMode->getParameterIndex()
+        || parameterIndex == chainParameters.linearPhaseLength->getParameterIndex()
+        || parameterIndex == chainParameters.linearPhaseBlockSize->getParameterIndex()
+        || parameterIndex == chainParameters.parallelChannels->getParameterIndex())
+        settingsNeedUpdate.store(true, std::memory_order_release);
+}
+
+void First_EQAudioProcessor::timerCallback()
+{
+    updateLatency();
+
+    if (! settingsNeedUpdate.exchange(false, std::memory_order_acquire))
+        return;
+
+    // The first switch to linear phase since prepareToPlay(). The audio thread doesn't
+    // touch the engine until it sees it ready.
+    if (chainParameters.eqMode->getIndex() == 1 && ! linearPhaseReady.load() && preparedChannels > 0)
+    {
+        linearPhaseEngine.prepare(getSampleRate(), preparedChannels);
+        linearPhaseReady.store(true, std::memory_order_release);
+    }
+
+    // Likewise Parallel Channels, whose job also leaves the pool again as soon as it is
+    // switched off
+    if (preparedChannels > 0)
+        updateChannelPool();
+}
+
+bool First_EQAudioProcessor::wantsChannelPool() const
+{
+    const auto numBatches = isUsingDoublePrecision() ? doubleBatches.numBatches : floatBatches.numBatches;
+    return chainParameters.parallelChannels->get() && numBatches >= minParallelBatches;
+}
+
+void First_EQAudioProcessor::updateChannelPool()
+{
+    if (! wantsChannelPool())
+    {
+        releaseChannelPool();
+        return;
+    }
+
+    // Falls back to serial processing if the pool has no slot left
+    if (! channelPoolReady.load())
+        channelPoolReady.store(channelPool->add(channelJob), std::memory_order_release);
+}
+
+void First_EQAudioProcessor::releaseChannelPool()
+{
+    // A block that saw the job ready may still be running it
+    channelPoolReady.store(false);
+    while (channelPoolInUse.load())
+        juce::Thread::yield();
+
+    channelPool->remove(channelJob);
+}
+
+void First_EQAudioProcessor::publishLatency() noexcept
+{
+    if (activeLinearPhase)
+    {
+        activeLatencySamples.store(linearPhaseEngine.getCurrentLatencySamples(), std::memory_order_relaxed);
+        if (getSampleRate() > 0)
+            tailLengthSeconds = linearPhaseEngine.getTailSamples() / getSampleRate();
+        return;
+    }
+
+    const auto latency = isUsingDoublePrecision()
+                           ? doubleOversampler.getLatencySamples(activeOversamplingFactor, activeLinearPhaseOversampling)
+                           : floatOversampler.getLatencySamples(activeOversamplingFactor, activeLinearPhaseOversampling);
+    activeLatencySamples.store(latency, std::memory_order_relaxed);
+}
+
+void First_EQAudioProcessor::updateLatency()
+{
+    // Only once the audio is running with it, so the host never compensates for a delay
+    // that isn't there yet
+    const auto latency = activeLatencySamples.load(std::memory_order_relaxed);
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout First_EQAudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+    layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut Freq", "LowCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq", "HighCut Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 20000.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq", "Peak Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.5f), 750.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain", "Peak Gain", juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality", "Peak Quality", juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+
+    // The choice lists are the same for every instance, so they are built once per
+    // process and shared: juce::String copies only add a reference to the same text.
+    static const auto slopeNames = []
+    {
+        juce::StringArray names;
+        for (int i = 0; i < 4; ++i)
+            names.add(juce::String(12 + i * 12) + " dB/Oct");
+        return names;
+    }();
+    static const juce::StringArray oversamplingNames { "Off", "2x", "4x" };
+    static const juce::StringArray phaseNames { "Minimum Phase", "Linear Phase" };
+    static const juce::StringArray bandTypes { "Peak", "Low Shelf", "High Shelf", "Notch" };
+    static const juce::StringArray linearPhaseLengths { "2048", "4096", "8192", "16384" };
+    static const juce::StringArray linearPhaseBlockSizes { "128", "256", "512", "1024", "2048" };
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", slopeNames, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", slopeNames, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling", oversamplingNames, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling Filter", "Oversampling Filter", phaseNames, 0));
+
+    // Added after the original parameters so that their indices stay put. Band 1 is the
+    // original peak band, the rest start switched off and spread across the spectrum.
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (band > 0)
+        {
+            const auto defaultFreq = std::round(juce::mapToLog10((band + 0.5f) / maxBands, 30.f, 16000.f));
+            layout.add(std::make_unique<juce::AudioParameterFloat>(getBandParameterID(band, "Freq"), getBandParameterID(band, "Freq"), juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.5f), defaultFreq));
+            layout.add(std::make_unique<juce::AudioParameterFloat>(getBandParameterID(band, "Gain"), getBandParameterID(band, "Gain"), juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f), 0.0f));
+            layout.add(std::make_unique<juce::AudioParameterFloat>(getBandParameterID(band, "Quality"), getBandParameterID(band, "Quality"), juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f), 1.f));
+        }
+        layout.add(std::make_unique<juce::AudioParameterChoice>(getBandParameterID(band, "Type"), getBandParameterID(band, "Type"), bandTypes, 0));
+        layout.add(std::make_unique<juce::AudioParameterBool>(getBandParameterID(band, "Enabled"), getBandParameterID(band, "Enabled"), band == 0));
+    }
+
+    // Linear phase mode. The length sets the steepness the FIR can reach at low
+    // frequencies and half of it is latency; the block size trades the rest of the
+    // latency against CPU.
+    layout.add(std::make_unique<juce::AudioParameterChoice>("EQ Mode", "EQ Mode", phaseNames, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Linear Phase Length", "Linear Phase Length", linearPhaseLengths, 2));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Linear Phase Block", "Linear Phase Block", linearPhaseBlockSizes, 2));
+
+    // Spreads the channels of large buses over a shared pool of worker threads. Off by
+    // default, since the workers spin between blocks while it is in use.
+    layout.add(std::make_unique<juce::AudioParameterBool>("Parallel Channels", "Parallel Channels", false));
+    return layout;
+}
+
+void First_EQAudioProcessor::resetAllParam()
+{
+    
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+    return new First_EQAudioProcessor();
+}
@@ -1,152 +1,296 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-
-//==============================================================================
-/**
-*/
-
-enum Slope
-{
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48
-};
-
-struct ChainSettings
-{
-    float peakFreq { 0 }, peakGainDecibels { 0 }, peakQuality { 1.f };
-    float lowCutFreq { 0 }, highCutFreq { 0 };
-    Slope lowCutSlope { Slope::Slope_12 }, highCutSlope { Slope::Slope_12 };
-};
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-
-using Filter = juce::dsp::IIR::Filter<float>;
-using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-enum ChainPositions
-{
-    LowCut,
-    Peak,
-    HighCut
-};
-
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, CoefficientType& coefficient)
-{
-    updateCoefficients(chain.template get<Index>().coefficients, coefficient[Index]);
-    chain.template setBypassed<Index>(false);
-}
-
-template<typename ChainType, typename CoefficientsType>
-void updateCutFilter(ChainType& chain,
-                     const CoefficientsType& coefficient,
-                     const Slope& slope)
-{
-    chain.template setBypassed<0>(true);
-    chain.template setBypassed<1>(true);
-    chain.template setBypassed<2>(true);
-    chain.template setBypassed<3>(true);
-    switch ( slope ) {
-        case Slope_48:
-        {
-            update<3>(chain, coefficient);
-        }
-        case Slope_36:
-        {
-            update<2>(chain, coefficient);
-        }
-        case Slope_24:
-        {
-            update<1>(chain, coefficient);
-        }
-        case Slope_12:
-        {
-            update<0>(chain, coefficient);
-        }
-    }
-}
-
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2 * (chainSettings.lowCutSlope + 1));
-}
-
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, (chainSettings.highCutSlope + 1)*2);
-}
-
-Coefficients makePeakFilter(const ChainSettings&, double sampleRate);
-
-class First_EQAudioProcessor  : public juce::AudioProcessor
-{
-public:
-    //==============================================================================
-    First_EQAudioProcessor();
-    ~First_EQAudioProcessor() override;
-
-    //==============================================================================
-    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override;
-
-   #ifndef JucePlugin_PreferredChannelConfigurations
-    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
-   #endif
-
-    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
-    //==============================================================================
-    juce::AudioProcessorEditor* createEditor() override;
-    bool hasEditor() const override;
-
-    //==============================================================================
-    const juce::String getName() const override;
-
-    bool acceptsMidi() const override;
-    bool producesMidi() const override;
-    bool isMidiEffect() const override;
-    double getTailLengthSeconds() const override;
-
-    //==============================================================================
-    int getNumPrograms() override;
-    int getCurrentProgram() override;
-    void setCurrentProgram (int index) override;
-    const juce::String getProgramName (int index) override;
-    void changeProgramName (int index, const juce::String& newName) override;
-
-    //==============================================================================
-    void getStateInformation (juce::MemoryBlock& destData) override;
-    void setStateInformation (const void* data, int sizeInBytes) override;
-    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
-    juce::AudioProcessorValueTreeState apvts {  
-        *this, nullptr, "Parameters", createParameterLayout()
-    };
-    
-    void resetAllParam();
-
-private:
-    
-    MonoChain leftChain, rightChain;
-    
-    void updatePeakFilter(const ChainSettings& chainSettings);
-    void updateLowCutFilter(const ChainSettings& chainSettings);
-    void updateHighCutFilter(const ChainSettings& chainSettings);
-    void updateFilter();
-    
-    //==============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (First_EQAudioProcessor)
-};
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterChain.h"
+#include "CoefficientDesigner.h"
+#include "ChainSmoother.h"
+#include "BatchChain.h"
+#include "ChainOversampler.h"
+#include "LinearPhaseEngine.h"
+#include "AnalyzerFifo.h"
+#include "BinaryState.h"
+#include "PresetBank.h"
+#include "DspLoadMonitor.h"
+#include "ChannelWorkerPool.h"
+
+//==============================================================================
+/**
+*/
+class First_EQAudioProcessor  : public juce::AudioProcessor,
+private juce::AudioProcessorParameter::Listener,
+private juce::Timer
+{
+public:
+    //==============================================================================
+    First_EQAudioProcessor();
+    ~First_EQAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+
+   #ifndef JucePlugin_PreferredChannelConfigurations
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+   #endif
+
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
+    void changeProgramName (int index, const juce::String& newName) override;
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    juce::AudioProcessorValueTreeState apvts {  
+        *this, nullptr, "Parameters", createParameterLayout()
+    };
+    
+    void resetAllParam();
+
+    // Mono mixdowns of every block before and after the EQ, for the editor's spectrum
+    // analyzer. Only filled while an analyzer has them enabled.
+    AnalyzerFifo preAnalyzerFifo, postAnalyzerFifo;
+
+    // How long this instance takes per block, against the time the block lasts. Readable
+    // from any thread; the editor's load overlay polls it.
+    const DspLoadMonitor& getLoadMonitor() const noexcept   { return loadMonitor; }
+    DspLoadMonitor& getLoadMonitor() noexcept               { return loadMonitor; }
+
+    // Also what the host sees as the plugin's programs
+    PresetBank& getPresetBank() noexcept                    { return presetBank; }
+
+    // Typed handles to the parameters, for reading the current settings cheaply
+    const ChainParameters& getChainParameters() const noexcept  { return chainParameters; }
+
+private:
+    
+    // Every channel shares the same coefficients, so channels are grouped into batches
+    // that each fill the lanes of one SIMD register. Up to 64 channel immersive beds.
+    static constexpr int maxChannels = 64;
+
+    // Just enough batches for the prepared channel count, allocated in prepareToPlay()
+    template <typename SampleType>
+    struct ChannelBatches
+    {
+        using Batch = BatchChain<SampleType>;
+
+        std::unique_ptr<Batch[]> batches;
+        int numBatches { 0 };
+
+        void allocate(int numChannels)
+        {
+            numBatches = (numChannels + Batch::numLanes - 1) / Batch::numLanes;
+            batches.reset(new Batch[(size_t) numBatches]);
+        }
+
+        size_t size() const noexcept                    { return (size_t) numBatches; }
+        Batch& operator[](size_t index) noexcept        { return batches[index]; }
+        Batch* begin() noexcept                         { return batches.get(); }
+        Batch* end() noexcept                           { return batches.get() + numBatches; }
+    };
+
+    // Only the set matching the host's processing precision is allocated
+    ChannelBatches<float> floatBatches;
+    ChannelBatches<double> doubleBatches;
+
+    template <typename SampleType>
+    ChannelBatches<SampleType>& getChannelBatches() noexcept
+    {
+        if constexpr (std::is_same<SampleType, double>::value)
+            return doubleBatches;
+        else
+            return floatBatches;
+    }
+
+    // When a slope, band type or on/off state switches, the chain as it was keeps running
+    // on a copy of the input for one equal gain crossfade into the switched chain. Only
+    // allocated for the processing precision, and only processed during a fade. Each
+    // batch uses just its own channels of the buffer.
+    template <typename SampleType>
+    struct Crossfade
+    {
+        ChannelBatches<SampleType> outgoing;
+        juce::AudioBuffer<SampleType> buffer;
+    };
+
+    Crossfade<float> floatCrossfade;
+    Crossfade<double> doubleCrossfade;
+    double fadePosition { 1 }, fadeIncrement { 0 };
+
+    // Switches that arrive mid-fade wait for it to finish, so a fade never restarts from
+    // a mix it can't reproduce
+    int deferredBands { 0 };
+
+    template <typename SampleType>
+    Crossfade<SampleType>& getCrossfade() noexcept
+    {
+        if constexpr (std::is_same<SampleType, double>::value)
+            return doubleCrossfade;
+        else
+            return floatCrossfade;
+    }
+
+    ChainOversampler<float> floatOversampler;
+    ChainOversampler<double> doubleOversampler;
+    int activeOversamplingFactor { 1 };
+    bool activeLinearPhaseOversampling { false };
+
+    template <typename SampleType>
+    ChainOversampler<SampleType>& getOversampler() noexcept
+    {
+        if constexpr (std::is_same<SampleType, double>::value)
+            return doubleOversampler;
+        else
+            return floatOversampler;
+    }
+
+    ChainParameters chainParameters { apvts };
+    CoefficientDesigner designer { chainParameters };
+
+    ChainSmoother smoother;
+
+    // Replaces the cascade and the oversampling stages while the EQ Mode is linear phase.
+    // Its buffers are most of an instance's memory, so they are only allocated once the
+    // mode is on: in prepareToPlay(), or on the message thread when the mode is switched
+    // on later, while the audio thread carries on with the cascade until linearPhaseReady.
+    LinearPhaseEngine linearPhaseEngine { chainParameters };
+    std::atomic<bool> linearPhaseReady { false };
+    bool activeLinearPhase { false };
+    int preparedChannels { 0 };
+
+    // Once the input has been silent for idleHangoverSamples, and the output with it, the
+    // filters are reset and processing stops until a non-silent block arrives. The
+    // hangover is how long the current filters need to decay by idleDecibels, so the
+    // state that gets dropped is far below anything audible.
+    static constexpr float silenceThreshold = 1.0e-6f;     // -120 dBFS
+    static constexpr double idleDecibels = 120.0;
+    int silentSamples { 0 }, idleHangoverSamples { 0 };
+    bool idle { false };
+
+    // Decay to -60 dB, for the host. Written on the audio thread.
+    std::atomic<double> tailLengthSeconds { 0 };
+
+    // The latency the audio is actually running with, which can trail the parameters by a
+    // while: the oversampling stages switch when the designer's coefficients arrive, and
+    // the linear phase engine when linearPhaseReady is set or its new kernel is taken. The
+    // audio thread keeps it up to date and the timer reports it to the host.
+    std::atomic<int> activeLatencySamples { 0 };
+
+    // With Parallel Channels on, batches are spread over the shared worker pool once a
+    // bus has at least minParallelBatches of them (16 channels of floats with SSE), one
+    // task per batch for the whole host block; Benchmark --parallel times both ways
+    // across bus sizes to check that threshold against. The job is only registered while
+    // the parameter is on, from prepareToPlay() or the message thread, and the audio
+    // thread only uses the pool once it sees channelPoolReady. It raises channelPoolInUse
+    // before looking, so the message thread can wait for it to finish with the job before
+    // taking the job out of the pool again.
+    static constexpr int minParallelBatches = 4;
+    juce::SharedResourcePointer<ChannelWorkerPool> channelPool;
+    ChannelWorkerPool::Job channelJob;
+    std::atomic<bool> channelPoolReady { false }, channelPoolInUse { false };
+
+    DspLoadMonitor loadMonitor;
+    PresetBank presetBank { *this };
+
+    // Hosts call parameter listeners on the audio thread, where posting a message would
+    // lock, so a change to one of the settings that needs the message thread only raises
+    // this flag, and a timer there picks it up.
+    static constexpr int settingsPollIntervalMs = 50;
+    std::atomic<bool> settingsNeedUpdate { false };
+
+    // Position on the smoother's fixed grid, carried across host blocks so the update
+    // rate doesn't depend on how the host slices its buffers.
+    int samplesUntilCoefficientUpdate { 0 };
+
+    // The smoother's grid over a host block, with the coefficients that change at each
+    // step. The audio thread works it out before any batch runs, so every batch can then
+    // go through the whole block on its own: one after the other, or one pool task each.
+    // Sized in prepareToPlay() for the host's block size, up to maxPlannedSubBlocks;
+    // longer blocks are planned and run in several goes.
+    struct SubBlock
+    {
+        int start { 0 }, numSamples { 0 };
+        int changedBands { 0 }, coefficientsIndex { 0 };
+        bool startsFade { false };
+        double fadePosition { 1 }, fadeIncrement { 0 };
+    };
+
+    static constexpr int maxPlannedSubBlocks = 64;
+    std::vector<SubBlock> plannedSubBlocks;
+    std::vector<ChainCoefficients> plannedCoefficients;
+    int numPlannedSubBlocks { 0 }, numPlannedCoefficients { 0 };
+
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override {}
+    void timerCallback() override;
+    void publishLatency() noexcept;
+    void updateLatency();
+
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer);
+    template <typename SampleType>
+    int planSubBlocks(int start, int numSamples);
+    template <typename SampleType>
+    void processBatches(SampleType* const* channelData, int numChannels);
+    template <typename SampleType>
+    void processBatch(int index, SampleType* const* channelData, int numChannels) noexcept;
+    template <typename SampleType>
+    void processChain(int index, juce::dsp::AudioBlock<SampleType> block, const SubBlock& subBlock) noexcept;
+    template <typename SampleType>
+    static void filterBatch(BatchChain<SampleType>& batch, juce::dsp::AudioBlock<SampleType> block) noexcept;
+    template <typename SampleType>
+    bool startCrossfade();
+
+    // What a pool task needs to process one batch, on the submitting thread's stack
+    template <typename SampleType>
+    struct BatchTask
+    {
+        First_EQAudioProcessor& processor;
+        SampleType* const* channelData;
+        int numChannels;
+    };
+
+    template <typename SampleType>
+    static void processBatchTask(void* context, int index);
+    bool wantsChannelPool() const;
+    void updateChannelPool();
+    void releaseChannelPool();
+
+    void updateFilter();
+    void updateMode();
+    void updateTail(const ChainCoefficients& chainCoefficients);
+    void resetFilters();
+    template <typename SampleType>
+    static void applyBandChanges(BatchChain<SampleType>& batch, const ChainCoefficients& chainCoefficients, int changedBands) noexcept;
+    
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (First_EQAudioProcessor)
+};
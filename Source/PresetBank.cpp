@@ -0,0 +1,180 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+PresetBank::PresetBank(juce::AudioProcessor& p) : processor(p)
+{
+    presets.push_back({ "Default", capture() });
+    abSlots[0] = presets.front().state;
+}
+
+juce::MemoryBlock PresetBank::capture() const
+{
+    juce::MemoryBlock state;
+    BinaryState::write(processor.getParameters(), state);
+    return state;
+}
+
+void PresetBank::apply(const juce::MemoryBlock& state)
+{
+    const auto applied = BinaryState::read(state.getData(), (int) state.getSize(), processor.getParameters());
+    jassert(applied);
+    juce::ignoreUnused(applied);
+}
+
+int PresetBank::getNumPresets() const
+{
+    const juce::ScopedLock sl(lock);
+    return (int) presets.size();
+}
+
+juce::String PresetBank::getName(int index) const
+{
+    const juce::ScopedLock sl(lock);
+    return juce::isPositiveAndBelow(index, (int) presets.size()) ? presets[(size_t) index].name : juce::String();
+}
+
+int PresetBank::getCurrentIndex() const
+{
+    const juce::ScopedLock sl(lock);
+    return currentIndex;
+}
+
+int PresetBank::store(const juce::String& name)
+{
+    int index;
+    {
+        const juce::ScopedLock sl(lock);
+        presets.push_back({ name, capture() });
+        index = currentIndex = (int) presets.size() - 1;
+    }
+
+    sendChangeMessage();
+    return index;
+}
+
+void PresetBank::rename(int index, const juce::String& name)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        if (! juce::isPositiveAndBelow(index, (int) presets.size()))
+            return;
+        presets[(size_t) index].name = name;
+    }
+
+    sendChangeMessage();
+}
+
+bool PresetBank::recall(int index)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        if (! juce::isPositiveAndBelow(index, (int) presets.size()))
+            return false;
+
+        apply(presets[(size_t) index].state);
+        currentIndex = index;
+    }
+
+    sendChangeMessage();
+    return true;
+}
+
+void PresetBank::switchAB()
+{
+    {
+        const juce::ScopedLock sl(lock);
+        abSlots[(size_t) activeAB] = capture();
+        activeAB = 1 - activeAB;
+
+        auto& other = abSlots[(size_t) activeAB];
+        if (other.isEmpty())
+            other = abSlots[(size_t) (1 - activeAB)];
+        else
+            apply(other);
+    }
+
+    sendChangeMessage();
+}
+
+bool PresetBank::isBActive() const
+{
+    const juce::ScopedLock sl(lock);
+    return activeAB == 1;
+}
+
+//==============================================================================
+// Layout, all little endian, straight after the parameters' BinaryState blob:
+//
+//   uint32  magic           "FEQB"
+//   uint16  numPresets
+//   uint16  currentIndex
+//   then per preset: the name as null terminated UTF-8, a uint32 size and that many
+//   bytes of BinaryState blob
+void PresetBank::writeTo(juce::OutputStream& out) const
+{
+    const juce::ScopedLock sl(lock);
+    jassert(presets.size() <= 0xffff);
+
+    out.writeInt((int) magic);
+    out.writeShort((short) presets.size());
+    out.writeShort((short) currentIndex);
+
+    for (const auto& preset : presets)
+    {
+        out.writeString(preset.name);
+        out.writeInt((int) preset.state.getSize());
+        out.write(preset.state.getData(), preset.state.getSize());
+    }
+}
+
+bool PresetBank::readFrom(const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < 8)
+        return false;
+
+    juce::MemoryInputStream in(data, (size_t) sizeInBytes, false);
+    if ((juce::uint32) in.readInt() != magic)
+        return false;
+
+    const auto numPresets = (int) (juce::uint16) in.readShort();
+    const auto index = (int) (juce::uint16) in.readShort();
+    if (numPresets == 0 || index >= numPresets)
+        return false;
+
+    // Everything is checked before the bank changes, so damaged data leaves it alone.
+    // Each blob is only checked for its magic here; recall() validates the rest.
+    std::vector<Preset> restored;
+    restored.reserve((size_t) numPresets);
+
+    for (int i = 0; i < numPresets; ++i)
+    {
+        Preset preset;
+        preset.name = in.readString();
+
+        const auto size = in.readInt();
+        if (size <= 0 || size > in.getNumBytesRemaining()
+            || in.readIntoMemoryBlock(preset.state, size) != (size_t) size
+            || ! BinaryState::isBinaryState(preset.state.getData(), size))
+            return false;
+
+        restored.push_back(std::move(preset));
+    }
+
+    {
+        const juce::ScopedLock sl(lock);
+        presets = std::move(restored);
+        currentIndex = index;
+        abSlots[1].reset();
+        activeAB = 0;
+    }
+
+    sendChangeMessage();
+    return true;
+}
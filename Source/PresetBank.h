@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    Named snapshots of every parameter, plus an A/B pair, all held in memory
+    and saved with the plugin state.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BinaryState.h"
+
+// Presets are kept as BinaryState blobs, so storing and recalling one is a copy of a few
+// hundred bytes and never touches the disk. Recalling only sets parameters, the same as
+// automation: the designer thread works out the new coefficients, continuous settings
+// ramp, and the processor crossfades to a second chain for anything that switches (see
+// First_EQAudioProcessor::startCrossfade()).
+//
+// Message thread, or whichever thread the host calls the program and state functions on;
+// the bank itself is locked, the parameters take care of themselves. Every change to the
+// list, the current preset or the A/B slot is broadcast, so the editor can follow what the
+// host does.
+class PresetBank  : public juce::ChangeBroadcaster
+{
+public:
+    // Starts out with the processor's current settings as "Default", and the same in A
+    explicit PresetBank(juce::AudioProcessor& processor);
+
+    int getNumPresets() const;
+    juce::String getName(int index) const;
+    int getCurrentIndex() const;
+
+    // Adds the current settings at the end and returns their index
+    int store(const juce::String& name);
+
+    void rename(int index, const juce::String& name);
+
+    // Returns false for an index out of range
+    bool recall(int index);
+
+    // Keeps the current settings in the active A/B slot and recalls the other one, which
+    // the first switch fills with a copy of the current settings
+    void switchAB();
+    bool isBActive() const;
+
+    // The presets and the current index, for the plugin state. The A/B pair is only there
+    // to compare against while editing, so it isn't kept, and restoring goes back to A.
+    void writeTo(juce::OutputStream& out) const;
+
+    // Replaces the whole bank. Returns false, leaving the bank as it was, for data that
+    // doesn't hold one.
+    bool readFrom(const void* data, int sizeInBytes);
+
+private:
+    static constexpr juce::uint32 magic = 0x42514546;   // "FEQB"
+
+    struct Preset
+    {
+        juce::String name;
+        juce::MemoryBlock state;
+    };
+
+    juce::MemoryBlock capture() const;
+    void apply(const juce::MemoryBlock& state);
+
+    juce::AudioProcessor& processor;
+    juce::CriticalSection lock;
+    std::vector<Preset> presets;
+    int currentIndex { 0 };
+
+    std::array<juce::MemoryBlock, 2> abSlots;
+    int activeAB { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (PresetBank)
+};
@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    ResponseCurveCalculator.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseCurveCalculator.h"
+
+ResponseCurveCalculator::CalculatorThread::CalculatorThread() : juce::Thread("EQ response curve")
+{
+    startThread(2);
+}
+
+ResponseCurveCalculator::CalculatorThread::~CalculatorThread()
+{
+    stopThread(1000);
+}
+
+void ResponseCurveCalculator::CalculatorThread::add(ResponseCurveCalculator* calculator)
+{
+    const juce::ScopedLock sl(lock);
+    calculators.addIfNotAlreadyThere(calculator);
+}
+
+void ResponseCurveCalculator::CalculatorThread::remove(ResponseCurveCalculator* calculator)
+{
+    const juce::ScopedLock sl(lock);
+    calculators.removeFirstMatchingValue(calculator);
+}
+
+void ResponseCurveCalculator::CalculatorThread::run()
+{
+    while (! threadShouldExit())
+    {
+        wait(-1);
+
+        const juce::ScopedLock sl(lock);
+        for (auto* calculator : calculators)
+            calculator->calculateIfRequested();
+    }
+}
+
+//==============================================================================
+ResponseCurveCalculator::ResponseCurveCalculator()
+{
+    calculatorThread->add(this);
+}
+
+ResponseCurveCalculator::~ResponseCurveCalculator()
+{
+    calculatorThread->remove(this);
+}
+
+void ResponseCurveCalculator::request(const ChainSettings& newSettings, double newSampleRate, juce::Rectangle<int> newArea)
+{
+    {
+        const juce::ScopedLock sl(requestLock);
+        requestedSettings = newSettings;
+        requestedSampleRate = newSampleRate;
+        requestedArea = newArea;
+        hasRequest = true;
+    }
+    calculatorThread->notify();
+}
+
+void ResponseCurveCalculator::calculateIfRequested()
+{
+    ChainSettings next;
+    double hostSampleRate = 0;
+    {
+        const juce::ScopedLock sl(requestLock);
+        if (! hasRequest)
+            return;
+        hasRequest = false;
+        next = requestedSettings;
+        hostSampleRate = requestedSampleRate;
+        area = requestedArea;
+    }
+
+    const auto sampleRate = hostSampleRate * next.oversamplingFactor;
+    const auto numColumns = juce::jmax(1, area.getWidth());
+    const auto gridChanged = numColumns != (int) cosOmega.size() || sampleRate != gridSampleRate;
+    if (gridChanged)
+    {
+        updateGrid(numColumns, sampleRate);
+        coefficients.sampleRate = sampleRate;
+    }
+
+    // Without a rate there is nothing to design; the tables just go flat
+    const auto canDesign = sampleRate > 0;
+
+    if (gridChanged || ! sameLowCut(next, coefficients.settings))
+    {
+        if (canDesign)
+            designLowCut(coefficients, next);
+        calculateTable(lowCutTable, coefficients.lowCut.data(), static_cast<int>(next.lowCutSlope) + 1);
+    }
+    if (gridChanged || ! sameHighCut(next, coefficients.settings))
+    {
+        if (canDesign)
+            designHighCut(coefficients, next);
+        calculateTable(highCutTable, coefficients.highCut.data(), static_cast<int>(next.highCutSlope) + 1);
+    }
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (gridChanged || ! sameBand(next.bands[(size_t) band], coefficients.settings.bands[(size_t) band]))
+        {
+            if (canDesign)
+                designBand(coefficients, next, band);
+            const auto& section = coefficients.bands[(size_t) band];
+            calculateTable(firstBandTable + band, &section, isIdentity(section) ? 0 : 1);
+        }
+    }
+
+    buildCurve(curves.getWriteBuffer());
+    curves.publish();
+}
+
+void ResponseCurveCalculator::updateGrid(int numColumns, double sampleRate)
+{
+    gridSampleRate = sampleRate;
+    cosOmega.resize((size_t) numColumns);
+    cos2Omega.resize((size_t) numColumns);
+    power.resize((size_t) numColumns);
+    for (auto& decibels : tableDecibels)
+        decibels.resize((size_t) numColumns);
+
+    if (sampleRate <= 0)
+        return;
+
+    for (int i = 0; i < numColumns; ++i)
+    {
+        const auto frequency = juce::mapToLog10(double(i) / double(numColumns), 20.0, 20000.0);
+        const auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        cosOmega[(size_t) i] = std::cos(omega);
+        cos2Omega[(size_t) i] = std::cos(2.0 * omega);
+    }
+}
+
+void ResponseCurveCalculator::calculateTable(int table, const BiquadCoefficients* sections, int numSections)
+{
+    auto& decibels = tableDecibels[(size_t) table];
+    if (gridSampleRate <= 0 || numSections == 0)
+    {
+        std::fill(decibels.begin(), decibels.end(), 0.0);
+        return;
+    }
+
+    // |H(e^jw)|^2 of a section is a ratio of two polynomials in cos(w) and cos(2w), so with
+    // those tabulated per column no trig is left, and each loop below is a straight pass
+    // over contiguous arrays that the compiler can vectorise.
+    const auto numColumns = power.size();
+    auto* const p = power.data();
+    const auto* const c1 = cosOmega.data();
+    const auto* const c2 = cos2Omega.data();
+
+    std::fill(power.begin(), power.end(), 1.0);
+
+    for (int s = 0; s < numSections; ++s)
+    {
+        const auto& c = sections[s];
+        const auto n0 = c.b0 * c.b0 + c.b1 * c.b1 + c.b2 * c.b2;
+        const auto n1 = 2.0 * (c.b0 * c.b1 + c.b1 * c.b2);
+        const auto n2 = 2.0 * c.b0 * c.b2;
+        const auto d0 = 1.0 + c.a1 * c.a1 + c.a2 * c.a2;
+        const auto d1 = 2.0 * (c.a1 + c.a1 * c.a2);
+        const auto d2 = 2.0 * c.a2;
+
+        for (size_t i = 0; i < numColumns; ++i)
+            p[i] *= (n0 + n1 * c1[i] + n2 * c2[i]) / (d0 + d1 * c1[i] + d2 * c2[i]);
+    }
+
+    auto* const db = decibels.data();
+    for (size_t i = 0; i < numColumns; ++i)
+        db[i] = 10.0 * std::log10(std::max(p[i], 1.0e-30));
+}
+
+void ResponseCurveCalculator::buildCurve(juce::Path& outline)
+{
+    // Clearing keeps the path's storage, so after the first few curves this allocates nothing
+    line.clear();
+    outline.clear();
+    if (area.isEmpty())
+        return;
+
+    const double outputMin = area.getBottom();
+    const double outputMax = area.getY();
+    // Disabled bands' tables are all zeros; summing them is cheaper than tracking them
+    auto& total = power;
+    std::fill(total.begin(), total.end(), 0.0);
+    for (const auto& decibels : tableDecibels)
+        for (size_t i = 0; i < total.size(); ++i)
+            total[i] += decibels[i];
+
+    for (size_t i = 0; i < total.size(); ++i)
+    {
+        const auto decibels = total[i];
+        const auto x = (float) (area.getX() + (int) i);
+        const auto y = (float) juce::jmap(decibels, -24.0, 24.0, outputMin, outputMax);
+
+        if (i == 0)
+            line.startNewSubPath(x, y);
+        else
+            line.lineTo(x, y);
+    }
+
+    juce::PathStrokeType(curveThickness).createStrokedPath(outline, line);
+}
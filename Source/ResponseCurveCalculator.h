@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    ResponseCurveCalculator.h
+    Designs and builds the editor's response curve on a background thread,
+    keeping a magnitude table per band.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterChain.h"
+#include "TripleBuffer.h"
+
+// The curve is sampled once per pixel column on a log frequency grid from 20 Hz to
+// 20 kHz. Each band keeps its own table in dB, and a new request only redesigns and
+// recomputes the bands whose settings differ from the last one, unless the grid itself
+// changed. Designs don't go through the shared CoefficientCache: while a knob is being
+// dragged almost every request is an intermediate value nobody else will use. The
+// finished curve comes back through a TripleBuffer as an already stroked outline, so
+// the message thread never waits for the calculation and paint() only fills it.
+class ResponseCurveCalculator
+{
+public:
+    ResponseCurveCalculator();
+    ~ResponseCurveCalculator();
+
+    // Message thread. Queues a curve for the given settings at the host's sample rate
+    // (the chain runs at that times the settings' oversampling factor), laid out in area;
+    // a request that arrives before the previous one was picked up replaces it. A zero
+    // sample rate gives a flat curve.
+    void request(const ChainSettings& settings, double sampleRate, juce::Rectangle<int> area);
+
+    static constexpr float curveThickness = 2.f;
+
+    // Message thread. Returns true if a newer curve has arrived since the last call.
+    bool updateCurve() noexcept                        { return curves.update(); }
+
+    // The outline of the curve stroked curveThickness wide, ready to be filled
+    const juce::Path& getCurve() const noexcept        { return curves.getReadBuffer(); }
+
+    //==============================================================================
+    // One thread per process serves every editor that is open, sleeping until one of
+    // them asks for a curve.
+    class CalculatorThread : public juce::Thread
+    {
+    public:
+        CalculatorThread();
+        ~CalculatorThread() override;
+
+        void add(ResponseCurveCalculator*);
+        void remove(ResponseCurveCalculator*);
+        void run() override;
+
+    private:
+        juce::CriticalSection lock;
+        juce::Array<ResponseCurveCalculator*> calculators;
+    };
+
+private:
+    enum { lowCutTable, highCutTable, firstBandTable, numTables = firstBandTable + maxBands };
+
+    void calculateIfRequested();
+    void updateGrid(int numColumns, double sampleRate);
+    void calculateTable(int table, const BiquadCoefficients* sections, int numSections);
+    void buildCurve(juce::Path& outline);
+
+    juce::CriticalSection requestLock;
+    ChainSettings requestedSettings;
+    double requestedSampleRate { 0 };
+    juce::Rectangle<int> requestedArea;
+    bool hasRequest { false };
+
+    // Only touched by the calculator thread
+    ChainCoefficients coefficients;
+    juce::Rectangle<int> area;
+    double gridSampleRate { -1 };
+    std::vector<double> cosOmega, cos2Omega, power;
+    std::array<std::vector<double>, numTables> tableDecibels;
+    juce::Path line;
+
+    TripleBuffer<juce::Path> curves;
+
+    juce::SharedResourcePointer<CalculatorThread> calculatorThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResponseCurveCalculator)
+};
@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+
+namespace
+{
+    constexpr int pollIntervalMs = 15;
+}
+
+SpectrumAnalyzer::AnalyzerThread::AnalyzerThread() : juce::Thread("EQ spectrum analyzer")
+{
+    startThread(2);
+}
+
+SpectrumAnalyzer::AnalyzerThread::~AnalyzerThread()
+{
+    stopThread(1000);
+}
+
+void SpectrumAnalyzer::AnalyzerThread::add(SpectrumAnalyzer* analyzer)
+{
+    const juce::ScopedLock sl(lock);
+    analyzers.addIfNotAlreadyThere(analyzer);
+}
+
+void SpectrumAnalyzer::AnalyzerThread::remove(SpectrumAnalyzer* analyzer)
+{
+    const juce::ScopedLock sl(lock);
+    analyzers.removeFirstMatchingValue(analyzer);
+}
+
+void SpectrumAnalyzer::AnalyzerThread::run()
+{
+    while (! threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            for (auto* analyzer : analyzers)
+                analyzer->analyse();
+        }
+        wait(pollIntervalMs);
+    }
+}
+
+//==============================================================================
+SpectrumAnalyzer::SpectrumAnalyzer(AnalyzerFifo& preEqFifo, AnalyzerFifo& postEqFifo)
+    : fftData((size_t) (2 * fftSize))
+{
+    taps[preEq].fifo = &preEqFifo;
+    taps[postEq].fifo = &postEqFifo;
+
+    for (auto& tap : taps)
+    {
+        tap.history.assign((size_t) fftSize, 0.f);
+        tap.averagedPower.assign((size_t) numBins, 0.f);
+
+        // Whatever is still queued is left over from the last time an analyzer was open
+        while (tap.fifo->pull(fftData.data(), (int) fftData.size()) > 0) {}
+        tap.fifo->setEnabled(true);
+    }
+
+    analyzerThread->add(this);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    analyzerThread->remove(this);
+
+    for (auto& tap : taps)
+        tap.fifo->setEnabled(false);
+}
+
+void SpectrumAnalyzer::setLayout(juce::Rectangle<int> newArea, double newSampleRate)
+{
+    const juce::ScopedLock sl(layoutLock);
+    requestedArea = newArea;
+    requestedSampleRate = newSampleRate;
+}
+
+bool SpectrumAnalyzer::updateSpectra() noexcept
+{
+    auto updated = false;
+    for (auto& tap : taps)
+        updated = tap.spectra.update() || updated;
+    return updated;
+}
+
+void SpectrumAnalyzer::analyse()
+{
+    bool layoutChanged;
+    {
+        const juce::ScopedLock sl(layoutLock);
+        layoutChanged = requestedArea != area || requestedSampleRate != sampleRate;
+        area = requestedArea;
+        sampleRate = requestedSampleRate;
+    }
+
+    if (layoutChanged)
+    {
+        // Fractional FFT bin under each pixel column
+        columnBins.resize(sampleRate > 0 ? (size_t) juce::jmax(0, area.getWidth()) : 0);
+        for (size_t i = 0; i < columnBins.size(); ++i)
+        {
+            const auto frequency = juce::mapToLog10(double(i) / double(columnBins.size()), 20.0, 20000.0);
+            columnBins[i] = (float) juce::jmin(frequency * fftSize / sampleRate, (double) (numBins - 1));
+        }
+    }
+
+    for (auto& tap : taps)
+        if (readFrames(tap) || layoutChanged)
+            buildSpectrum(tap);
+}
+
+bool SpectrumAnalyzer::readFrames(TapState& tap)
+{
+    auto newFrame = false;
+
+    for (;;)
+    {
+        // The newest hopSize samples of the history fill up from the queue
+        auto* dest = tap.history.data() + (fftSize - hopSize) + tap.numPending;
+        tap.numPending += tap.fifo->pull(dest, hopSize - tap.numPending);
+        if (tap.numPending < hopSize)
+            return newFrame;
+
+        std::copy(tap.history.begin(), tap.history.end(), fftData.begin());
+        window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+        fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+        for (int bin = 0; bin < numBins; ++bin)
+        {
+            const auto magnitude = fftData[(size_t) bin];
+            auto& power = tap.averagedPower[(size_t) bin];
+            power = averaging * power + (1.f - averaging) * magnitude * magnitude;
+        }
+
+        std::copy(tap.history.begin() + hopSize, tap.history.end(), tap.history.begin());
+        tap.numPending = 0;
+        newFrame = true;
+    }
+}
+
+void SpectrumAnalyzer::buildSpectrum(TapState& tap)
+{
+    auto& outline = tap.spectra.getWriteBuffer();
+    tap.line.clear();
+    outline.clear();
+
+    if (! area.isEmpty() && ! columnBins.empty())
+    {
+        // A Hann window halves a sine's peak, so full scale lands at fftSize / 4
+        const auto normalisation = 4.f / (float) fftSize;
+        const auto powerScale = normalisation * normalisation;
+        const auto bottom = (float) area.getBottom();
+        const auto top = (float) area.getY();
+
+        for (size_t i = 0; i < columnBins.size(); ++i)
+        {
+            const auto bin = columnBins[i];
+            const auto index = (int) bin;
+            const auto next = juce::jmin(index + 1, numBins - 1);
+            const auto power = tap.averagedPower[(size_t) index]
+                             + (bin - (float) index) * (tap.averagedPower[(size_t) next] - tap.averagedPower[(size_t) index]);
+
+            const auto decibels = juce::jlimit(minDecibels, 0.f, 10.f * std::log10(std::max(power * powerScale, 1.0e-20f)));
+            const auto x = (float) (area.getX() + (int) i);
+            const auto y = juce::jmap(decibels, minDecibels, 0.f, bottom, top);
+
+            if (i == 0)
+                tap.line.startNewSubPath(x, y);
+            else
+                tap.line.lineTo(x, y);
+        }
+
+        juce::PathStrokeType(curveThickness).createStrokedPath(outline, tap.line);
+    }
+
+    tap.spectra.publish();
+}
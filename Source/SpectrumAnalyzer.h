@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+    Turns the processor's pre and post EQ sample queues into averaged spectra
+    and ready-to-fill paths for the editor, on a background thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "AnalyzerFifo.h"
+#include "TripleBuffer.h"
+
+// Enables both queues for as long as it exists. Every hopSize new samples a Hann windowed
+// FFT frame is taken and folded into an exponential average of the power spectrum. The
+// average is then sampled once per pixel column on the same 20 Hz - 20 kHz log grid
+// the response curve uses, and the stroked outline is handed to the message thread
+// through a TripleBuffer.
+class SpectrumAnalyzer
+{
+public:
+    enum Tap { preEq, postEq, numTaps };
+
+    static constexpr float curveThickness = 1.f;
+
+    SpectrumAnalyzer(AnalyzerFifo& preEqFifo, AnalyzerFifo& postEqFifo);
+    ~SpectrumAnalyzer();
+
+    // Message thread
+    void setLayout(juce::Rectangle<int> area, double sampleRate);
+
+    // Message thread. Returns true if either tap has a newer spectrum since the last call.
+    bool updateSpectra() noexcept;
+    const juce::Path& getSpectrum(Tap tap) const noexcept   { return taps[(size_t) tap].spectra.getReadBuffer(); }
+
+    //==============================================================================
+    // One thread per process serves every open analyzer, polling their queues.
+    class AnalyzerThread : public juce::Thread
+    {
+    public:
+        AnalyzerThread();
+        ~AnalyzerThread() override;
+
+        void add(SpectrumAnalyzer*);
+        void remove(SpectrumAnalyzer*);
+        void run() override;
+
+    private:
+        juce::CriticalSection lock;
+        juce::Array<SpectrumAnalyzer*> analyzers;
+    };
+
+private:
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 2;
+    static constexpr int numBins = fftSize / 2 + 1;
+    static constexpr float averaging = 0.7f;
+    static constexpr float minDecibels = -96.f;
+
+    struct TapState
+    {
+        AnalyzerFifo* fifo = nullptr;
+        std::vector<float> history, averagedPower;
+        int numPending { 0 };
+        juce::Path line;
+        TripleBuffer<juce::Path> spectra;
+    };
+
+    void analyse();
+    bool readFrames(TapState& tap);
+    void buildSpectrum(TapState& tap);
+
+    juce::CriticalSection layoutLock;
+    juce::Rectangle<int> requestedArea;
+    double requestedSampleRate { 0 };
+
+    // Only touched by the analyzer thread
+    juce::Rectangle<int> area;
+    double sampleRate { 0 };
+    std::vector<float> columnBins;
+
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+    std::vector<float> fftData;
+
+    std::array<TapState, numTaps> taps;
+
+    juce::SharedResourcePointer<AnalyzerThread> analyzerThread;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyzer)
+};
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Wait-free single producer / single consumer handoff of a value type.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// The writer fills getWriteBuffer() and calls publish(); the reader calls update()
+// and, if it returns true, finds the most recently published value in getReadBuffer().
+// Neither side ever blocks or allocates, and the reader's buffer stays untouched by
+// the writer until the reader moves on to a newer one.
+template <typename ValueType>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    //==============================================================================
+    ValueType& getWriteBuffer() noexcept              { return slots[(size_t) backIndex]; }
+
+    void publish() noexcept
+    {
+        const auto previous = middle.exchange(backIndex | newDataFlag, std::memory_order_acq_rel);
+        backIndex = previous & indexMask;
+    }
+
+    //==============================================================================
+    bool update() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & newDataFlag) == 0)
+            return false;
+
+        const auto previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & indexMask;
+        return true;
+    }
+
+    const ValueType& getReadBuffer() const noexcept   { return slots[(size_t) frontIndex]; }
+
+private:
+    static constexpr int newDataFlag = 4, indexMask = 3;
+
+    std::array<ValueType, 3> slots;
+    std::atomic<int> middle { 1 };
+    int backIndex { 0 }, frontIndex { 2 };
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
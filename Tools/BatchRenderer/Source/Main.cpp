@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Headless batch renderer: runs audio files through First_EQAudioProcessor
+    with a saved plugin state, several files at a time.
+
+    BatchRenderer --state <file> --output <dir> [--threads <n>] [--block-size <n>]
+                  <input files...>
+
+    The state file holds the raw blob written by getStateInformation(). Output
+    files keep their input's name, format, sample rate and (where the format
+    allows) bit depth, so inputs must have distinct names and must not live in
+    the output directory. No audio device or display is touched.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+namespace
+{
+    constexpr int defaultBlockSize = 8192;
+
+    struct RenderResult
+    {
+        bool succeeded { false };
+        juce::String message;
+        double audioSeconds { 0.0 };
+        double renderSeconds { 0.0 };
+    };
+
+    // Mapping the whole file lets reads come straight from the page cache instead of going
+    // through a buffered stream. Formats that can't be mapped (FLAC) fall back to the usual
+    // reader.
+    std::unique_ptr<juce::AudioFormatReader> createReader(juce::AudioFormatManager& formatManager, const juce::File& file)
+    {
+        if (auto* format = formatManager.findFormatForFileExtension(file.getFileExtension()))
+        {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(format->createMemoryMappedReader(file));
+            if (mapped != nullptr && mapped->mapEntireFile())
+                return mapped;
+        }
+
+        return std::unique_ptr<juce::AudioFormatReader>(formatManager.createReaderFor(file));
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> createWriter(juce::AudioFormatManager& formatManager, const juce::File& file,
+                                                          const juce::AudioFormatReader& reader)
+    {
+        auto* format = formatManager.findFormatForFileExtension(file.getFileExtension());
+        if (format == nullptr)
+            return {};
+
+        auto bitDepth = (int) reader.bitsPerSample;
+        if (! format->getPossibleBitDepths().contains(bitDepth))
+            bitDepth = 24;
+
+        file.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
+        if (stream == nullptr)
+            return {};
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), reader.sampleRate,
+                                                                                reader.numChannels, bitDepth,
+                                                                                reader.metadataValues, 0));
+        if (writer != nullptr)
+            stream.release();   // now owned by the writer
+
+        return writer;
+    }
+
+    //==============================================================================
+    // Each job owns its own processor, so files never share filter state and the jobs
+    // need no locking between them.
+    class RenderJob  : public juce::ThreadPoolJob
+    {
+    public:
+        RenderJob(const juce::File& inputFile, const juce::File& outputFile, const juce::MemoryBlock& state,
+                  int blockSize, RenderResult& result)
+            : juce::ThreadPoolJob(inputFile.getFileName()),
+              input(inputFile), output(outputFile), state(state), blockSize(blockSize), result(result)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            result.message = render();
+            result.succeeded = result.message.isEmpty();
+            result.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+            return jobHasFinished;
+        }
+
+    private:
+        juce::String render()
+        {
+            juce::AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+
+            auto reader = createReader(formatManager, input);
+            if (reader == nullptr)
+                return "cannot read " + input.getFullPathName();
+
+            const auto numChannels = (int) reader->numChannels;
+            const auto lengthInSamples = reader->lengthInSamples;
+
+            First_EQAudioProcessor processor;
+            processor.setStateInformation(state.getData(), (int) state.getSize());
+
+            juce::AudioProcessor::BusesLayout layout;
+            layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+            layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+            if (! processor.setBusesLayout(layout))
+                return juce::String(numChannels) + " channels are not supported: " + input.getFullPathName();
+
+            processor.setNonRealtime(true);
+            processor.prepareToPlay(reader->sampleRate, blockSize);
+
+            auto writer = createWriter(formatManager, output, *reader);
+            if (writer == nullptr)
+                return "cannot write " + output.getFullPathName();
+
+            // Run the latency's worth of silence through after the file ends and drop the
+            // same amount from the front, so the output lines up with the input.
+            const auto latency = (juce::int64) processor.getLatencySamples();
+            juce::AudioBuffer<float> buffer(numChannels, blockSize);
+            juce::MidiBuffer midi;
+
+            for (juce::int64 position = 0; position < lengthInSamples + latency; position += blockSize)
+            {
+                const auto numSamples = (int) juce::jmin((juce::int64) blockSize, lengthInSamples + latency - position);
+                const auto numToRead = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, lengthInSamples - position);
+
+                buffer.setSize(numChannels, numSamples, false, false, true);
+                buffer.clear();
+                if (numToRead > 0)
+                    reader->read(&buffer, 0, numToRead, position, true, true);
+
+                processor.processBlock(buffer, midi);
+
+                const auto numToSkip = (int) juce::jlimit((juce::int64) 0, (juce::int64) numSamples, latency - position);
+                if (numSamples > numToSkip
+                    && ! writer->writeFromAudioSampleBuffer(buffer, numToSkip, numSamples - numToSkip))
+                    return "write failed for " + output.getFullPathName();
+            }
+
+            processor.releaseResources();
+            result.audioSeconds = (double) lengthInSamples / reader->sampleRate;
+            return {};
+        }
+
+        const juce::File input, output;
+        const juce::MemoryBlock& state;
+        const int blockSize;
+        RenderResult& result;
+    };
+
+    int fail(const juce::String& message)
+    {
+        std::cerr << message << std::endl;
+        return 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // Every processor starts a timer that picks up mode changes on the message thread, so a
+    // message manager has to exist. Nothing here dispatches it; the settings are all in
+    // place before prepareToPlay(), which applies them itself.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args(argc, argv);
+
+    const auto stateFile = args.removeValueForOption("--state");
+    const auto outputDirectory = args.removeValueForOption("--output");
+    const auto numThreads = args.containsOption("--threads") ? args.removeValueForOption("--threads").getIntValue()
+                                                             : juce::SystemStats::getNumCpus();
+    const auto blockSize = args.containsOption("--block-size") ? args.removeValueForOption("--block-size").getIntValue()
+                                                               : defaultBlockSize;
+
+    if (stateFile.isEmpty() || outputDirectory.isEmpty() || args.size() == 0 || numThreads < 1 || blockSize < 1)
+        return fail("usage: " + args.executableName
+                    + " --state <file> --output <dir> [--threads <n>] [--block-size <n>] <input files...>");
+
+    juce::MemoryBlock state;
+    if (! juce::File::getCurrentWorkingDirectory().getChildFile(stateFile).loadFileAsData(state))
+        return fail("cannot read state file " + stateFile);
+
+    const auto outputDir = juce::File::getCurrentWorkingDirectory().getChildFile(outputDirectory);
+    if (! outputDir.createDirectory())
+        return fail("cannot create " + outputDir.getFullPathName());
+
+    // Outputs are named after their inputs, so check up front that no job would write over
+    // an input (or one it is still reading) or over another job's output.
+    juce::Array<juce::File> inputs, outputs;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        const auto input = args[i].resolveAsFile();
+        const auto output = outputDir.getChildFile(input.getFileName());
+        if (outputs.contains(output))
+            return fail("more than one input would be written to " + output.getFullPathName());
+
+        inputs.add(input);
+        outputs.add(output);
+    }
+
+    for (const auto& output : outputs)
+        if (inputs.contains(output))
+            return fail("output would overwrite input " + output.getFullPathName());
+
+    std::vector<RenderResult> results((size_t) args.size());
+    juce::ThreadPool pool(numThreads);
+
+    const auto start = juce::Time::getMillisecondCounterHiRes();
+
+    for (int i = 0; i < inputs.size(); ++i)
+        pool.addJob(new RenderJob(inputs[i], outputs[i], state, blockSize, results[(size_t) i]), true);
+
+    while (pool.getNumJobs() > 0)
+        juce::Thread::sleep(20);
+
+    const auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+    int numFailed = 0;
+    double totalAudioSeconds = 0.0;
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        if (! result.succeeded)
+        {
+            ++numFailed;
+            std::cerr << "error: " << result.message << std::endl;
+            continue;
+        }
+
+        totalAudioSeconds += result.audioSeconds;
+        std::cout << inputs[(int) i].getFileName() << ": "
+                  << juce::String(result.audioSeconds, 2) << " s of audio in "
+                  << juce::String(result.renderSeconds, 2) << " s ("
+                  << juce::String(result.audioSeconds / juce::jmax(result.renderSeconds, 1.0e-9), 1)
+                  << "x realtime)" << std::endl;
+    }
+
+    std::cout << (int) results.size() - numFailed << " of " << (int) results.size() << " files, "
+              << juce::String(totalAudioSeconds, 2) << " s of audio in " << juce::String(wallSeconds, 2)
+              << " s on " << numThreads << " threads ("
+              << juce::String(totalAudioSeconds / juce::jmax(wallSeconds, 1.0e-9), 1) << "x realtime)" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,595 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    DSP micro-benchmark for First_EQAudioProcessor::processBlock and the raw
+    BatchChain cascade.
+
+    Benchmark [--output <file>] [--label <text>] [--samples <n>] [--repeats <n>]
+    Benchmark --parallel [--samples <n>] [--repeats <n>]
+    Benchmark --check-design
+    Benchmark --check-state
+
+    Every combination of low cut / high cut slope, block size (1 to 4096),
+    mono / stereo and automation rate is timed, and the results are written as
+    JSON. Costs are per sample frame, i.e. all channels of one sample. Use
+    --label to tag a run with e.g. the commit it was built from, and compare
+    runs from the same machine only.
+
+    --parallel instead times the processor on 4 to 64 channel buses with
+    Parallel Channels off and on, which is what the processor's
+    minParallelBatches threshold has to be checked against.
+
+    --check-design instead compares BandDesignTable against the exact band
+    designers over the whole parameter range at the common sample rates, prints
+    the worst coefficient error and the cost of both, and fails if the error
+    exceeds BandDesignTable::maxCoefficientError.
+
+    --check-state round-trips random settings through the binary state format
+    and the legacy ValueTree blobs, checks that a damaged binary blob is
+    rejected without touching anything, that a blob or legacy tree from an
+    older, shorter layout resets the newer parameters to their defaults and
+    that a stored preset survives the round trip, and prints the cost of a
+    restore in both formats.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/BandDesignTable.h"
+
+#include "../../Common/HeapHooks.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+//==============================================================================
+// Every heap allocation in the process goes through these, so a measured section can
+// count what it allocates.
+namespace AllocationCounter
+{
+    static std::atomic<bool> counting { false };
+    static std::atomic<juce::int64> count { 0 };
+}
+
+void HeapHooks::allocated(std::size_t) noexcept
+{
+    if (AllocationCounter::counting.load(std::memory_order_relaxed))
+        AllocationCounter::count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void HeapHooks::deallocated(std::size_t) noexcept
+{
+}
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSizes[] { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    constexpr int channelCounts[] { 1, 2 };
+
+    // How many blocks pass between parameter moves; 0 never moves them
+    struct Automation
+    {
+        const char* name;
+        int blocksBetweenChanges;
+    };
+
+    constexpr Automation automationRates[]
+    {
+        { "static",       0 },
+        { "every64Blocks", 64 },
+        { "every8Blocks",  8 },
+        { "everyBlock",    1 }
+    };
+
+    // Time stamp counter ticks on x86, which track nominal rather than boosted core
+    // clocks. Elsewhere there is no portable counter, and the cycle figures are left out.
+    juce::uint64 readCycleCounter() noexcept
+    {
+       #if JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #else
+        return 0;
+       #endif
+    }
+
+    struct Measurement
+    {
+        double nsPerSample { std::numeric_limits<double>::max() };
+        double cyclesPerSample { std::numeric_limits<double>::max() };
+        juce::int64 allocations { 0 };
+    };
+
+    // Times repeats passes of processBlock(numSamples) after one untimed warm-up pass and
+    // keeps the fastest, which is the least disturbed by the rest of the system.
+    template <typename ProcessBlock>
+    Measurement measure(int numSamples, int blockSize, int repeats, ProcessBlock&& processBlock)
+    {
+        const auto numBlocks = juce::jmax(1, numSamples / blockSize);
+        const auto runPass = [&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+                processBlock(block);
+        };
+
+        runPass();
+
+        Measurement result;
+        for (int i = 0; i < repeats; ++i)
+        {
+            AllocationCounter::count = 0;
+            AllocationCounter::counting = true;
+            const auto startTicks = juce::Time::getHighResolutionTicks();
+            const auto startCycles = readCycleCounter();
+
+            runPass();
+
+            const auto cycles = readCycleCounter() - startCycles;
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+            AllocationCounter::counting = false;
+
+            const auto numProcessed = (double) numBlocks * blockSize;
+            result.nsPerSample = juce::jmin(result.nsPerSample, seconds * 1.0e9 / numProcessed);
+            result.cyclesPerSample = juce::jmin(result.cyclesPerSample, (double) cycles / numProcessed);
+            result.allocations = juce::jmax(result.allocations, AllocationCounter::count.load());
+        }
+
+        return result;
+    }
+
+    // Sweeps a value back and forth between two limits, one step per change
+    float sweep(float start, float end, int step) noexcept
+    {
+        constexpr int stepsPerSweep = 64;
+        const auto position = std::abs((step % (2 * stepsPerSweep)) - stepsPerSweep) / (float) stepsPerSweep;
+        return start * std::pow(end / start, position);
+    }
+
+    ChainSettings makeSettings(Slope lowCutSlope, Slope highCutSlope)
+    {
+        ChainSettings settings;
+        settings.lowCutFreq = 80.f;
+        settings.highCutFreq = 12000.f;
+        settings.bands[0].enabled = true;
+        settings.bands[0].freq = 1000.f;
+        settings.bands[0].gainDecibels = 6.f;
+        settings.bands[0].quality = 1.f;
+        settings.lowCutSlope = lowCutSlope;
+        settings.highCutSlope = highCutSlope;
+        return settings;
+    }
+
+    //==============================================================================
+    Measurement benchmarkProcessor(const ChainSettings& settings, int blockSize, int numChannels,
+                                   const Automation& automation, int numSamples, int repeats,
+                                   bool parallelChannels = false)
+    {
+        auto processor = std::make_unique<First_EQAudioProcessor>();
+        auto& apvts = processor->apvts;
+
+        const auto setParameter = [&apvts](const char* id, float value)
+        {
+            auto* parameter = apvts.getParameter(id);
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        };
+
+        setParameter("LowCut Freq", settings.lowCutFreq);
+        setParameter("HighCut Freq", settings.highCutFreq);
+        setParameter("Peak Freq", settings.bands[0].freq);
+        setParameter("Peak Gain", settings.bands[0].gainDecibels);
+        setParameter("Peak Quality", settings.bands[0].quality);
+        setParameter("LowCut Slope", (float) settings.lowCutSlope);
+        setParameter("HighCut Slope", (float) settings.highCutSlope);
+        setParameter("Parallel Channels", parallelChannels ? 1.f : 0.f);
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+        layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+        processor->setBusesLayout(layout);
+        processor->prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+        juce::Random random(1);
+        int step = 0;
+
+        auto result = measure(numSamples, blockSize, repeats, [&](int block)
+        {
+            if (automation.blocksBetweenChanges > 0 && block % automation.blocksBetweenChanges == 0)
+            {
+                ++step;
+                setParameter("Peak Freq", sweep(200.f, 5000.f, step));
+                setParameter("LowCut Freq", sweep(40.f, 400.f, step));
+            }
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* data = buffer.getWritePointer(ch);
+                for (int i = 0; i < blockSize; ++i)
+                    data[i] = random.nextFloat() * 2.f - 1.f;
+            }
+
+            processor->processBlock(buffer, midi);
+        });
+
+        processor->releaseResources();
+        return result;
+    }
+
+    // The cascade alone, fed the same way the processor feeds it. Automation here redesigns
+    // the moving bands inline, as the smoother would.
+    Measurement benchmarkChain(const ChainSettings& initialSettings, int blockSize, int numChannels,
+                               const Automation& automation, int numSamples, int repeats)
+    {
+        auto chain = std::make_unique<BatchChain<float>>();
+        auto settings = initialSettings;
+        auto coefficients = makeChainCoefficients(settings, sampleRate);
+        const auto designTable = BandDesignTable::getShared(sampleRate);
+        chain->setLowCut(coefficients.lowCut, settings.lowCutSlope);
+        chain->setBand(0, coefficients.bands[0]);
+        chain->setHighCut(coefficients.highCut, settings.highCutSlope);
+
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::Random random(1);
+        float* channels[BatchChain<float>::numLanes] {};
+        int step = 0;
+
+        return measure(numSamples, blockSize, repeats, [&](int block)
+        {
+            if (automation.blocksBetweenChanges > 0 && block % automation.blocksBetweenChanges == 0)
+            {
+                ++step;
+                settings.bands[0].freq = sweep(200.f, 5000.f, step);
+                settings.lowCutFreq = sweep(40.f, 400.f, step);
+                designBand(coefficients, settings, 0, designTable.get());
+                designLowCut(coefficients, settings);
+                chain->setBand(0, coefficients.bands[0]);
+                chain->setLowCut(coefficients.lowCut, settings.lowCutSlope);
+            }
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* data = buffer.getWritePointer(ch);
+                for (int i = 0; i < blockSize; ++i)
+                    data[i] = random.nextFloat() * 2.f - 1.f;
+            }
+
+            for (int start = 0; start < blockSize; start += BatchChain<float>::maxBlockSize)
+            {
+                for (int ch = 0; ch < numChannels; ++ch)
+                    channels[ch] = buffer.getWritePointer(ch) + start;
+                chain->process(channels, numChannels, juce::jmin(BatchChain<float>::maxBlockSize, blockSize - start));
+            }
+        });
+    }
+
+    // The processor on buses from below to well above minParallelBatches, with Parallel
+    // Channels off and on, at the steepest slopes and with the peak moving every block
+    void benchmarkParallelChannels(int numSamples, int repeats)
+    {
+        const auto settings = makeSettings(Slope_48, Slope_48);
+        const auto& automation = automationRates[std::size(automationRates) - 1];
+
+        for (auto numChannels : { 4, 8, 12, 16, 24, 32, 64 })
+        {
+            for (auto blockSize : { 64, 256, 1024 })
+            {
+                const auto serial = benchmarkProcessor(settings, blockSize, numChannels, automation, numSamples, repeats, false);
+                const auto parallel = benchmarkProcessor(settings, blockSize, numChannels, automation, numSamples, repeats, true);
+
+                std::cout << numChannels << " channels, block of " << blockSize
+                          << ": serial " << serial.nsPerSample << " ns, parallel " << parallel.nsPerSample
+                          << " ns, speedup " << serial.nsPerSample / parallel.nsPerSample
+                          << (parallel.allocations > 0 ? "  ALLOCATES" : "") << std::endl;
+            }
+        }
+    }
+
+    int slopeInDecibels(Slope slope) noexcept
+    {
+        return 12 * ((int) slope + 1);
+    }
+
+    //==============================================================================
+    double maxDifference(const BiquadCoefficients& a, const BiquadCoefficients& b) noexcept
+    {
+        return juce::jmax(juce::jmax(std::abs(a.b0 - b.b0), std::abs(a.b1 - b.b1), std::abs(a.b2 - b.b2)),
+                          juce::jmax(std::abs(a.a1 - b.a1), std::abs(a.a2 - b.a2)));
+    }
+
+    // Every band type over 20 Hz - 20 kHz (or Nyquist), the full Q range and +/-24 dB
+    bool checkDesignTables()
+    {
+        constexpr int numFrequencies = 500;
+        const BandType types[] = { BandType_Peak, BandType_LowShelf, BandType_HighShelf, BandType_Notch };
+        const char* typeNames[] = { "peak", "low shelf", "high shelf", "notch" };
+        auto passed = true;
+
+        for (auto rate : { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 })
+        {
+            const auto table = BandDesignTable::getShared(rate);
+            const auto maxFrequency = juce::jmin(20000.0, rate * 0.5);
+
+            std::vector<BandSettings> bands;
+            for (int f = 0; f < numFrequencies; ++f)
+                for (auto quality = 0.1f; quality <= 10.f; quality *= 1.5f)
+                    for (auto gain = -24.f; gain <= 24.f; gain += 0.75f)
+                        bands.push_back({ true, BandType_Peak, (float) (20.0 * std::pow(maxFrequency / 20.0, f / (numFrequencies - 1.0))), gain, quality });
+
+            for (size_t t = 0; t < std::size(types); ++t)
+            {
+                double worst = 0, exactSeconds = 0, tableSeconds = 0;
+                std::vector<BiquadCoefficients> exact(bands.size()), tabulated(bands.size());
+
+                for (auto& band : bands)
+                    band.type = types[t];
+
+                auto start = juce::Time::getHighResolutionTicks();
+                for (size_t i = 0; i < bands.size(); ++i)
+                    exact[i] = makeBandBiquad(rate, bands[i]);
+                exactSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+                start = juce::Time::getHighResolutionTicks();
+                for (size_t i = 0; i < bands.size(); ++i)
+                    tabulated[i] = table->makeBandBiquad(bands[i]);
+                tableSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+                for (size_t i = 0; i < bands.size(); ++i)
+                    worst = juce::jmax(worst, maxDifference(exact[i], tabulated[i]));
+
+                const auto ok = worst <= BandDesignTable::maxCoefficientError;
+                passed = passed && ok;
+
+                std::cout << rate << " Hz " << typeNames[t] << ": max error " << worst
+                          << ", exact " << exactSeconds * 1.0e9 / (double) bands.size() << " ns"
+                          << ", table " << tableSeconds * 1.0e9 / (double) bands.size() << " ns"
+                          << (ok ? "" : "  FAILED") << std::endl;
+            }
+        }
+
+        return passed;
+    }
+
+    //==============================================================================
+    void randomiseParameters(juce::AudioProcessor& processor, juce::Random& random)
+    {
+        for (auto* parameter : processor.getParameters())
+            parameter->setValueNotifyingHost(random.nextFloat());
+    }
+
+    bool sameParameters(juce::AudioProcessor& a, juce::AudioProcessor& b)
+    {
+        const auto& parametersA = a.getParameters();
+        const auto& parametersB = b.getParameters();
+        for (int i = 0; i < parametersA.size(); ++i)
+            if (std::abs(parametersA[i]->getValue() - parametersB[i]->getValue()) > 1.0e-6f)
+                return false;
+        return true;
+    }
+
+    bool checkState()
+    {
+        constexpr int numRestores = 1000;
+        juce::Random random(1);
+        First_EQAudioProcessor source, target;
+        auto passed = true;
+
+        auto check = [&passed](bool ok, const char* what)
+        {
+            std::cout << what << (ok ? ": ok" : ": FAILED") << std::endl;
+            passed = passed && ok;
+        };
+
+        // Two sets of settings, so that every timed restore actually changes something
+        std::array<juce::MemoryBlock, 2> binary, legacy;
+        for (size_t i = 0; i < binary.size(); ++i)
+        {
+            randomiseParameters(source, random);
+            source.getStateInformation(binary[i]);
+            juce::MemoryOutputStream out(legacy[i], false);
+            source.apvts.copyState().writeToStream(out);
+        }
+
+        target.setStateInformation(binary[1].getData(), (int) binary[1].getSize());
+        check(sameParameters(source, target), "binary round trip");
+
+        target.setStateInformation(binary[0].getData(), (int) binary[0].getSize());
+        target.setStateInformation(legacy[1].getData(), (int) legacy[1].getSize());
+        check(sameParameters(source, target), "legacy round trip");
+
+        // The parameters come first, followed by the preset bank
+        auto damaged = binary[0];
+        static_cast<char*>(damaged.getData())[BinaryState::getSize(damaged.getData(), (int) damaged.getSize()) / 2] ^= 0x10;
+        target.setStateInformation(damaged.getData(), (int) damaged.getSize());
+        check(sameParameters(source, target), "damaged blob rejected");
+
+        // A blob from a build that had only the first half of the parameters: the rest
+        // has to come back at its defaults, not at whatever the target held
+        {
+            juce::Array<juce::AudioProcessorParameter*> older;
+            const auto& all = source.getParameters();
+            for (int i = 0; i < all.size() / 2; ++i)
+                older.add(all[i]);
+
+            auto restoresDefaults = [&]
+            {
+                auto ok = true;
+                const auto& restored = target.getParameters();
+                for (int i = 0; i < restored.size(); ++i)
+                {
+                    const auto expected = i < older.size() ? all[i]->getValue() : restored[i]->getDefaultValue();
+                    ok = ok && std::abs(restored[i]->getValue() - expected) <= 1.0e-6f;
+                }
+                return ok;
+            };
+
+            juce::MemoryBlock olderBlob;
+            BinaryState::write(older, olderBlob);
+            target.setStateInformation(olderBlob.getData(), (int) olderBlob.getSize());
+            check(restoresDefaults(), "older layout restores defaults");
+
+            // The same for a legacy tree from a build that didn't have those parameters yet
+            auto olderTree = source.apvts.copyState();
+            for (int i = older.size(); i < all.size(); ++i)
+                if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*>(all[i]))
+                    olderTree.removeChild(olderTree.getChildWithProperty("id", withID->paramID), nullptr);
+
+            juce::MemoryBlock olderLegacy;
+            {
+                juce::MemoryOutputStream out(olderLegacy, false);
+                olderTree.writeToStream(out);
+            }
+
+            target.setStateInformation(binary[0].getData(), (int) binary[0].getSize());
+            target.setStateInformation(olderLegacy.getData(), (int) olderLegacy.getSize());
+            check(restoresDefaults(), "older legacy tree restores defaults");
+        }
+
+        {
+            source.getPresetBank().store("Stored");
+            juce::MemoryBlock withPreset;
+            source.getStateInformation(withPreset);
+            target.setStateInformation(withPreset.getData(), (int) withPreset.getSize());
+
+            const auto& bank = target.getPresetBank();
+            check(bank.getNumPresets() == source.getPresetBank().getNumPresets()
+                    && bank.getCurrentIndex() == source.getPresetBank().getCurrentIndex()
+                    && bank.getName(bank.getCurrentIndex()) == "Stored",
+                  "preset bank round trip");
+        }
+
+        std::cout << "state size: binary " << binary[0].getSize() << " bytes, legacy " << legacy[0].getSize() << " bytes" << std::endl;
+
+        for (auto* blobs : { &binary, &legacy })
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            for (int i = 0; i < numRestores; ++i)
+            {
+                const auto& blob = (*blobs)[(size_t) (i & 1)];
+                target.setStateInformation(blob.getData(), (int) blob.getSize());
+            }
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+            std::cout << (blobs == &binary ? "binary" : "legacy") << " restore: "
+                      << seconds * 1.0e6 / numRestores << " us" << std::endl;
+        }
+
+        return passed;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // Every processor starts a timer that picks up mode changes on the message thread, so a
+    // message manager has to exist. Nothing here dispatches it; the settings are all in
+    // place before prepareToPlay(), which applies them itself.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args(argc, argv);
+
+    if (args.removeOptionIfFound("--check-design"))
+        return checkDesignTables() ? 0 : 1;
+
+    if (args.removeOptionIfFound("--check-state"))
+        return checkState() ? 0 : 1;
+
+    const auto parallel = args.removeOptionIfFound("--parallel");
+    const auto outputFile = args.removeValueForOption("--output");
+    const auto label = args.removeValueForOption("--label");
+    const auto numSamples = args.containsOption("--samples") ? args.removeValueForOption("--samples").getIntValue() : 1 << 16;
+    const auto repeats = args.containsOption("--repeats") ? args.removeValueForOption("--repeats").getIntValue() : 5;
+
+    if (args.size() != 0 || numSamples < 1 || repeats < 1)
+    {
+        std::cerr << "usage: " << args.executableName
+                  << " [--output <file>] [--label <text>] [--samples <n>] [--repeats <n>] | --parallel [--samples <n>] [--repeats <n>]"
+                  << " | --check-design | --check-state" << std::endl;
+        return 1;
+    }
+
+    if (parallel)
+    {
+        benchmarkParallelChannels(numSamples, repeats);
+        return 0;
+    }
+
+    const bool hasCycleCounter = readCycleCounter() != 0;
+    juce::Array<juce::var> results;
+
+    for (auto lowCutSlope : { Slope_12, Slope_24, Slope_36, Slope_48 })
+    {
+        for (auto highCutSlope : { Slope_12, Slope_24, Slope_36, Slope_48 })
+        {
+            const auto settings = makeSettings(lowCutSlope, highCutSlope);
+
+            for (auto blockSize : blockSizes)
+            {
+                for (auto numChannels : channelCounts)
+                {
+                    for (const auto& automation : automationRates)
+                    {
+                        for (auto target : { "processor", "chain" })
+                        {
+                            const auto isProcessor = juce::String(target) == "processor";
+                            const auto measurement = isProcessor
+                                                       ? benchmarkProcessor(settings, blockSize, numChannels, automation, numSamples, repeats)
+                                                       : benchmarkChain(settings, blockSize, numChannels, automation, numSamples, repeats);
+
+                            auto* result = new juce::DynamicObject();
+                            result->setProperty("target", target);
+                            result->setProperty("lowCutSlope", slopeInDecibels(lowCutSlope));
+                            result->setProperty("highCutSlope", slopeInDecibels(highCutSlope));
+                            result->setProperty("blockSize", blockSize);
+                            result->setProperty("channels", numChannels);
+                            result->setProperty("automation", automation.name);
+                            result->setProperty("nsPerSample", measurement.nsPerSample);
+                            result->setProperty("cyclesPerSample", hasCycleCounter ? juce::var(measurement.cyclesPerSample) : juce::var());
+                            result->setProperty("allocations", measurement.allocations);
+                            results.add(juce::var(result));
+                        }
+                    }
+                }
+            }
+
+            std::cerr << "slopes " << slopeInDecibels(lowCutSlope) << "/" << slopeInDecibels(highCutSlope) << " done" << std::endl;
+        }
+    }
+
+    auto* machine = new juce::DynamicObject();
+    machine->setProperty("cpu", juce::SystemStats::getCpuModel());
+    machine->setProperty("cpuSpeedMHz", juce::SystemStats::getCpuSpeedInMegahertz());
+    machine->setProperty("cores", juce::SystemStats::getNumPhysicalCpus());
+    machine->setProperty("os", juce::SystemStats::getOperatingSystemName());
+
+    auto* report = new juce::DynamicObject();
+    report->setProperty("label", label);
+    report->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    report->setProperty("machine", juce::var(machine));
+    report->setProperty("juceVersion", juce::SystemStats::getJUCEVersion());
+    report->setProperty("sampleRate", sampleRate);
+    report->setProperty("samplesPerCase", numSamples);
+    report->setProperty("repeats", repeats);
+    report->setProperty("results", results);
+
+    const auto json = juce::JSON::toString(juce::var(report));
+
+    if (outputFile.isEmpty())
+    {
+        std::cout << json << std::endl;
+    }
+    else if (! juce::File::getCurrentWorkingDirectory().getChildFile(outputFile).replaceWithText(json))
+    {
+        std::cerr << "cannot write " << outputFile << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    HeapHooks.h
+    Replaces the global operator new and delete for the tools that need to see
+    every heap allocation the process makes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_WINDOWS
+ #include <malloc.h>
+#endif
+
+// Include from exactly one translation unit of a tool (its Main.cpp) and define the two
+// hooks there. They are called for every non-null block with the size that was asked
+// for, before it is handed out and before it is released. They must not allocate.
+//
+// Each block carries a small header in front of it with that size and the distance back
+// to what the system allocator returned, so the sizes are exact on every platform and
+// freeing never has to ask the allocator, or know the alignment, again.
+namespace HeapHooks
+{
+    void allocated(std::size_t size) noexcept;
+    void deallocated(std::size_t size) noexcept;
+
+    struct Header
+    {
+        std::size_t size, offset;
+    };
+
+    inline void* allocate(std::size_t size, std::size_t alignment)
+    {
+        // The header takes a whole alignment unit, so the block after it stays aligned
+        alignment = juce::jmax(alignment, alignof(std::max_align_t), sizeof(Header));
+        const auto total = alignment + juce::jmax((std::size_t) 1, size);
+
+       #if JUCE_WINDOWS
+        auto* raw = _aligned_malloc(total, alignment);
+       #else
+        void* raw = nullptr;
+        if (posix_memalign(&raw, alignment, total) != 0)
+            raw = nullptr;
+       #endif
+        if (raw == nullptr)
+            throw std::bad_alloc();
+
+        auto* p = static_cast<char*>(raw) + alignment;
+        *(reinterpret_cast<Header*>(p) - 1) = { size, alignment };
+        allocated(size);
+        return p;
+    }
+
+    inline void deallocate(void* p) noexcept
+    {
+        if (p == nullptr)
+            return;
+
+        const auto header = *(reinterpret_cast<Header*>(p) - 1);
+        deallocated(header.size);
+
+        auto* raw = static_cast<char*>(p) - header.offset;
+       #if JUCE_WINDOWS
+        _aligned_free(raw);
+       #else
+        std::free(raw);
+       #endif
+    }
+}
+
+void* operator new (std::size_t size)                               { return HeapHooks::allocate(size, alignof(std::max_align_t)); }
+void* operator new[] (std::size_t size)                             { return HeapHooks::allocate(size, alignof(std::max_align_t)); }
+void* operator new (std::size_t size, std::align_val_t alignment)   { return HeapHooks::allocate(size, (std::size_t) alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment) { return HeapHooks::allocate(size, (std::size_t) alignment); }
+void operator delete (void* p) noexcept                             { HeapHooks::deallocate(p); }
+void operator delete[] (void* p) noexcept                           { HeapHooks::deallocate(p); }
+void operator delete (void* p, std::size_t) noexcept                { HeapHooks::deallocate(p); }
+void operator delete[] (void* p, std::size_t) noexcept              { HeapHooks::deallocate(p); }
+void operator delete (void* p, std::align_val_t) noexcept           { HeapHooks::deallocate(p); }
+void operator delete[] (void* p, std::align_val_t) noexcept         { HeapHooks::deallocate(p); }
+void operator delete (void* p, std::size_t, std::align_val_t) noexcept   { HeapHooks::deallocate(p); }
+void operator delete[] (void* p, std::size_t, std::align_val_t) noexcept { HeapHooks::deallocate(p); }
@@ -0,0 +1,417 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Real-time safety check for First_EQAudioProcessor::processBlock.
+
+    RealtimeCheck [--seconds <n>] [--seed <n>]
+
+    A dedicated audio thread drives the processor through random sample rates,
+    channel layouts, precisions and block sizes (including 0 and 1), with random
+    parameter automation between blocks and stretches of digital silence, while
+    the main thread runs the message loop and keeps restoring random states the
+    way a host's message thread would. The processor's timer therefore applies
+    EQ Mode and Parallel Channels changes while blocks are running, as it does
+    in a host. Every heap allocation and every blocking call (mutex lock,
+    sleep) the audio thread makes inside processBlock, or while applying
+    automation, is reported once per call site, with its stack trace, and the
+    exit code is non-zero if there was any.
+
+    Automation is applied just before each block on the audio thread, as hosts
+    deliver it, and is checked along with the block, so the plugin's parameter
+    listener is covered. The only calls let through are the locks JUCE's
+    listener dispatch takes itself, told apart by their stack frames; that
+    needs symbol names, hence -rdynamic on Linux. Blocking calls are
+    only caught on Linux and macOS, where the pthread functions can be
+    interposed; allocations are caught everywhere. When a case runs with
+    Parallel Channels on, the 16 and 64 channel buses hand batches to the
+    processor's worker threads; only the audio thread's side of that is checked.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+#include "../../Common/HeapHooks.h"
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+//==============================================================================
+namespace RealtimeChecker
+{
+    // Only set on the audio thread, around automation and processBlock
+    static thread_local bool checking = false;
+
+    // Set while a violation is being recorded, so the bookkeeping itself is never reported
+    static thread_local bool recording = false;
+
+    // What the audio thread was doing, for the report. Only touched by the audio thread.
+    static juce::String context;
+
+    struct Violation
+    {
+        juce::String call, context;
+        int count { 0 };
+    };
+
+    struct Log
+    {
+        juce::CriticalSection lock;
+        std::map<juce::String, Violation> violations;   // keyed by stack trace
+    };
+
+    static Log& getLog()
+    {
+        static Log log;
+        return log;
+    }
+
+    // JUCE's parameter listener dispatch locks its listener lists whatever the plugin
+    // does, so those locks alone are let through: the frame right below the lock has to
+    // be the dispatch itself. Anything a listener of the plugin's does is still reported.
+    static bool isListenerLock(const juce::String& stackTrace)
+    {
+        const auto frames = juce::StringArray::fromLines(stackTrace);
+        for (int i = 1; i < frames.size(); ++i)
+            if (frames[i].contains("sendValueChangedMessageToListeners"))
+                return frames[i - 1].contains("CriticalSection") || frames[i - 1].contains("pthread_mutex_lock");
+
+        return false;
+    }
+
+    static void report(const char* call) noexcept
+    {
+        if (! checking || recording)
+            return;
+
+        recording = true;
+        if (const auto stackTrace = juce::SystemStats::getStackBacktrace(); ! isListenerLock(stackTrace))
+        {
+            auto& log = getLog();
+            const juce::ScopedLock sl(log.lock);
+            auto& violation = log.violations[stackTrace];
+            if (violation.count++ == 0)
+            {
+                violation.call = call;
+                violation.context = context;
+            }
+        }
+        recording = false;
+    }
+
+    // RAII marker for the checked region
+    struct ScopedCheck
+    {
+        ScopedCheck() noexcept   { checking = true; }
+        ~ScopedCheck() noexcept  { checking = false; }
+    };
+}
+
+void HeapHooks::allocated(std::size_t) noexcept
+{
+    RealtimeChecker::report("operator new");
+}
+
+void HeapHooks::deallocated(std::size_t) noexcept
+{
+    RealtimeChecker::report("operator delete");
+}
+
+//==============================================================================
+// The executable's own definitions take precedence over the C library's, which are
+// looked up lazily with RTLD_NEXT. No function-local statics here: their guards can
+// take a mutex themselves.
+#if JUCE_LINUX || JUCE_MAC
+namespace
+{
+    template <typename Function>
+    Function findNext(std::atomic<Function>& next, const char* name) noexcept
+    {
+        auto function = next.load(std::memory_order_acquire);
+        if (function == nullptr)
+        {
+            function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+            next.store(function, std::memory_order_release);
+        }
+        return function;
+    }
+
+    using MutexLockFunction = int (*)(pthread_mutex_t*);
+    using SleepFunction = int (*)(useconds_t);
+    using NanoSleepFunction = int (*)(const struct timespec*, struct timespec*);
+
+    std::atomic<MutexLockFunction> nextMutexLock { nullptr };
+    std::atomic<SleepFunction> nextSleep { nullptr };
+    std::atomic<NanoSleepFunction> nextNanoSleep { nullptr };
+}
+
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    RealtimeChecker::report("pthread_mutex_lock");
+
+    // dlsym may lock on its very first call, before anything else runs
+    if (auto* next = findNext(nextMutexLock, "pthread_mutex_lock"))
+        return next(mutex);
+    return 0;
+}
+
+extern "C" int usleep(useconds_t microseconds)
+{
+    RealtimeChecker::report("usleep");
+    return findNext(nextSleep, "usleep")(microseconds);
+}
+
+extern "C" int nanosleep(const struct timespec* duration, struct timespec* remaining)
+{
+    RealtimeChecker::report("nanosleep");
+    return findNext(nextNanoSleep, "nanosleep")(duration, remaining);
+}
+#endif
+
+//==============================================================================
+namespace
+{
+    constexpr double sampleRates[] { 44100.0, 48000.0, 96000.0, 192000.0 };
+    constexpr int channelCounts[] { 1, 2, 6, 12, 16, 64 };
+    constexpr int maxBlockSizes[] { 64, 512, 4096 };
+    constexpr double secondsPerCase = 0.5;
+
+    juce::AudioChannelSet getChannelSet(int numChannels)
+    {
+        switch (numChannels)
+        {
+            case 6:  return juce::AudioChannelSet::create5point1();
+            case 12: return juce::AudioChannelSet::create7point1point4();
+            case 16: return juce::AudioChannelSet::ambisonic(3);
+            default: return juce::AudioChannelSet::canonicalChannelSet(numChannels);
+        }
+    }
+
+    // Every parameter anywhere in its range: choices and switches included, since those
+    // are the ones that change the processing structure
+    void automate(juce::AudioProcessor& processor, juce::Random& random, int numChanges)
+    {
+        const auto& parameters = processor.getParameters();
+        for (int i = 0; i < numChanges; ++i)
+        {
+            auto* parameter = parameters[random.nextInt(parameters.size())];
+            parameter->setValueNotifyingHost(random.nextFloat());
+        }
+    }
+
+    //==============================================================================
+    class AudioThread : public juce::Thread
+    {
+    public:
+        AudioThread(First_EQAudioProcessor& p, juce::int64 seed, double seconds)
+            : juce::Thread("Audio"), processor(p), random(seed), runSeconds(seconds)
+        {
+        }
+
+        void run() override
+        {
+            const auto endTime = juce::Time::getMillisecondCounterHiRes() + runSeconds * 1000.0;
+
+            while (! threadShouldExit() && juce::Time::getMillisecondCounterHiRes() < endTime)
+            {
+                const auto doublePrecision = random.nextBool();
+                if (doublePrecision)
+                    runCase<double>();
+                else
+                    runCase<float>();
+                ++numCases;
+            }
+        }
+
+        int numCases { 0 };
+        juce::int64 numBlocks { 0 };
+
+    private:
+        template <typename SampleType>
+        void runCase()
+        {
+            const auto sampleRate = sampleRates[random.nextInt((int) std::size(sampleRates))];
+            const auto numChannels = channelCounts[random.nextInt((int) std::size(channelCounts))];
+            const auto maxBlockSize = maxBlockSizes[random.nextInt((int) std::size(maxBlockSizes))];
+            const auto isDouble = std::is_same<SampleType, double>::value;
+
+            // Everything up to the first block is allowed to allocate. Hosts prepare on the
+            // message thread, so the processor's timer never runs alongside prepareToPlay()
+            // or releaseResources(); holding the message manager lock does the same from here.
+            {
+                const juce::MessageManagerLock mml(this);
+                if (! mml.lockWasGained())
+                    return;
+
+                juce::AudioProcessor::BusesLayout layout;
+                layout.inputBuses.add(getChannelSet(numChannels));
+                layout.outputBuses.add(getChannelSet(numChannels));
+                processor.setBusesLayout(layout);
+                processor.setProcessingPrecision(isDouble ? juce::AudioProcessor::doublePrecision
+                                                          : juce::AudioProcessor::singlePrecision);
+                processor.setRateAndBufferSizeDetails(sampleRate, maxBlockSize);
+                processor.prepareToPlay(sampleRate, maxBlockSize);
+            }
+
+            juce::AudioBuffer<SampleType> buffer(numChannels, maxBlockSize);
+            juce::MidiBuffer midi;
+            const auto caseContext = juce::String(sampleRate) + " Hz, " + juce::String(numChannels) + " channels, "
+                                   + (isDouble ? "double" : "float");
+
+            int silentBlocksLeft = 0;
+            for (double elapsed = 0; elapsed < secondsPerCase && ! threadShouldExit();)
+            {
+                // Mostly full blocks, as hosts mostly send them, with the odd ragged one
+                const auto blockSize = random.nextInt(10) < 7 ? maxBlockSize : random.nextInt(maxBlockSize + 1);
+
+                const auto numChanges = random.nextInt(8) == 0 ? 1 + random.nextInt(3) : 0;
+
+                // Now and then a stretch of silence long enough to put the processor to sleep
+                if (silentBlocksLeft == 0 && random.nextInt(200) == 0)
+                    silentBlocksLeft = juce::roundToInt(sampleRate / juce::jmax(1, blockSize));
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                {
+                    auto* data = buffer.getWritePointer(ch);
+                    for (int i = 0; i < blockSize; ++i)
+                        data[i] = silentBlocksLeft > 0 ? SampleType(0) : SampleType(random.nextFloat() * 2.f - 1.f);
+                }
+                silentBlocksLeft = juce::jmax(0, silentBlocksLeft - 1);
+
+                RealtimeChecker::context = caseContext + ", block of " + juce::String(blockSize)
+                                         + (silentBlocksLeft > 0 ? ", silent" : "")
+                                         + (numChanges > 0 ? ", automated" : "");
+
+                juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), numChannels, blockSize);
+                {
+                    const RealtimeChecker::ScopedCheck check;
+                    automate(processor, random, numChanges);
+                    processor.processBlock(block, midi);
+                }
+
+                ++numBlocks;
+                elapsed += blockSize / sampleRate;
+
+                // Leave the other threads some air, as a real audio callback would
+                if (numBlocks % 64 == 0)
+                    juce::Thread::yield();
+            }
+
+            const juce::MessageManagerLock mml(this);
+            if (mml.lockWasGained())
+                processor.releaseResources();
+        }
+
+        First_EQAudioProcessor& processor;
+        juce::Random random;
+        double runSeconds;
+    };
+
+    // A state with every parameter somewhere random, built on a scratch instance
+    juce::MemoryBlock makeRandomState(juce::Random& random)
+    {
+        First_EQAudioProcessor scratch;
+        for (auto* parameter : scratch.getParameters())
+            parameter->setValueNotifyingHost(random.nextFloat());
+
+        juce::MemoryBlock state;
+        scratch.getStateInformation(state);
+        return state;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // Every processor starts a timer that picks up mode changes on the message thread, so a
+    // message manager has to exist. The main thread runs its dispatch loop, so automated
+    // mode changes take effect mid-case, as they would in a host.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args(argc, argv);
+
+    const auto seconds = args.containsOption("--seconds") ? args.removeValueForOption("--seconds").getDoubleValue() : 30.0;
+    const auto seed = args.containsOption("--seed") ? args.removeValueForOption("--seed").getLargeIntValue()
+                                                    : juce::Time::currentTimeMillis();
+
+    if (args.size() != 0 || seconds <= 0)
+    {
+        std::cerr << "usage: " << args.executableName << " [--seconds <n>] [--seed <n>]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "seed " << seed << std::endl;
+
+    First_EQAudioProcessor processor;
+    juce::Random random(seed + 1);
+
+    // A few states to restore from, prepared up front
+    std::vector<juce::MemoryBlock> states;
+    for (int i = 0; i < 16; ++i)
+        states.push_back(makeRandomState(random));
+
+    AudioThread audioThread(processor, seed, seconds);
+    audioThread.startThread(8);
+
+    // The main thread plays the host's message thread: state restores, saves and A/B
+    // switches at random while the audio thread is running. Restores and switches both
+    // make the audio thread crossfade wherever a slope, type or on/off state changes. In
+    // between it dispatches messages, so the processor's timer prepares the linear phase
+    // engine and adds the channel job to the pool or takes it out again while blocks run.
+    int numRestores = 0;
+    while (audioThread.isThreadRunning())
+    {
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(10 + random.nextInt(90));
+
+        switch (random.nextInt(3))
+        {
+            case 0:
+            {
+                const auto& state = states[(size_t) random.nextInt((int) states.size())];
+                processor.setStateInformation(state.getData(), (int) state.getSize());
+                ++numRestores;
+                break;
+            }
+
+            case 1:
+            {
+                juce::MemoryBlock saved;
+                processor.getStateInformation(saved);
+                break;
+            }
+
+            default:
+                processor.getPresetBank().switchAB();
+                ++numRestores;
+                break;
+        }
+    }
+
+    std::cout << audioThread.numCases << " cases, " << audioThread.numBlocks << " blocks, "
+              << numRestores << " state restores" << std::endl;
+
+    auto& log = RealtimeChecker::getLog();
+    const juce::ScopedLock sl(log.lock);
+
+    if (log.violations.empty())
+    {
+        std::cout << "no allocations or blocking calls on the audio thread" << std::endl;
+        return 0;
+    }
+
+    std::cout << log.violations.size() << " call sites allocate or block on the audio thread" << std::endl;
+    for (const auto& entry : log.violations)
+    {
+        const auto& violation = entry.second;
+        std::cout << std::endl << violation.call << " (" << violation.count << "x, first during "
+                  << violation.context << ")" << std::endl << entry.first << std::endl;
+    }
+
+    return 1;
+}
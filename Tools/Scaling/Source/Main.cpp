@@ -0,0 +1,371 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Footprint and scaling harness: many First_EQAudioProcessor instances in one
+    process, driven the way a host's audio graph drives them.
+
+    Scaling [--instances <n>] [--threads <n>] [--seconds <n>] [--block <n>]
+            [--channels <n>] [--linear-phase] [--parallel-channels]
+            [--output <file>]
+
+    First the instances are built and prepared one after the other, and the
+    heap bytes they hold and the growth of the resident set are reported per
+    instance, for construction and prepareToPlay separately, along with how
+    long each took.
+
+    Then every instance processes one block per graph cycle, with the instances
+    handed out to a pool of 1, 2, 4, ... up to --threads threads (the calling
+    thread included) through a shared counter, the way a host spreads
+    independent nodes over its audio workers. For each pool size the report has
+    the cycles run, the cycles that took longer than one block lasts, and the
+    throughput as instance-seconds of audio per second, which is how many
+    instances the machine could keep running in real time at that thread count.
+
+    Every instance gets four bands, an 80 Hz 24 dB/oct low cut and a 12 kHz
+    high cut, and fresh noise every block, so nothing goes idle. The resident
+    set is only measured on Linux and macOS. The shared coefficient cache's
+    hits and misses so far are reported after preparing. --parallel-channels
+    switches on the processors' own channel worker pool, which only takes over
+    for buses of 16 channels and up (--channels goes to 64).
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/CoefficientCache.h"
+#include "../../../Source/PluginProcessor.h"
+
+#include "../../Common/HeapHooks.h"
+
+#if JUCE_LINUX
+ #include <unistd.h>
+#elif JUCE_MAC
+ #include <mach/mach.h>
+#endif
+
+//==============================================================================
+// Every heap allocation in the process goes through these, so the harness can tell
+// exactly how many bytes are live at any point.
+namespace HeapCounter
+{
+    static std::atomic<juce::int64> liveBytes { 0 };
+}
+
+void HeapHooks::allocated(std::size_t size) noexcept
+{
+    HeapCounter::liveBytes.fetch_add((juce::int64) size, std::memory_order_relaxed);
+}
+
+void HeapHooks::deallocated(std::size_t size) noexcept
+{
+    HeapCounter::liveBytes.fetch_sub((juce::int64) size, std::memory_order_relaxed);
+}
+
+namespace
+{
+    constexpr double sampleRate = 48000.0;
+
+    // -1 where the platform has no cheap way to ask
+    juce::int64 getResidentBytes()
+    {
+       #if JUCE_LINUX
+        long totalPages = 0, residentPages = 0;
+        if (auto* file = std::fopen("/proc/self/statm", "r"))
+        {
+            const auto numRead = std::fscanf(file, "%ld %ld", &totalPages, &residentPages);
+            std::fclose(file);
+            if (numRead == 2)
+                return (juce::int64) residentPages * sysconf(_SC_PAGESIZE);
+        }
+        return -1;
+       #elif JUCE_MAC
+        mach_task_basic_info info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) == KERN_SUCCESS)
+            return (juce::int64) info.resident_size;
+        return -1;
+       #else
+        return -1;
+       #endif
+    }
+
+    struct Footprint
+    {
+        juce::int64 heapBytes, residentBytes;
+
+        static Footprint now()    { return { HeapCounter::liveBytes.load(), getResidentBytes() }; }
+    };
+
+    juce::var describeGrowth(const Footprint& before, const Footprint& after, double seconds, int numInstances)
+    {
+        auto* result = new juce::DynamicObject();
+        result->setProperty("heapBytesPerInstance", (double) (after.heapBytes - before.heapBytes) / numInstances);
+        if (before.residentBytes >= 0 && after.residentBytes >= 0)
+            result->setProperty("residentBytesPerInstance", (double) (after.residentBytes - before.residentBytes) / numInstances);
+        result->setProperty("microsecondsPerInstance", seconds * 1.0e6 / numInstances);
+        return juce::var(result);
+    }
+
+    void setParameter(First_EQAudioProcessor& processor, const juce::String& id, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(id);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // A typical channel strip
+    void setUpInstance(First_EQAudioProcessor& processor, bool linearPhase, bool parallelChannels)
+    {
+        setParameter(processor, "LowCut Freq", 80.f);
+        setParameter(processor, "LowCut Slope", (float) Slope_24);
+        setParameter(processor, "HighCut Freq", 12000.f);
+        setParameter(processor, "HighCut Slope", (float) Slope_12);
+        setParameter(processor, "EQ Mode", linearPhase ? 1.f : 0.f);
+        setParameter(processor, "Parallel Channels", parallelChannels ? 1.f : 0.f);
+
+        const float freqs[] { 200.f, 800.f, 3000.f, 8000.f };
+        for (int band = 0; band < 4; ++band)
+        {
+            setParameter(processor, getBandParameterID(band, "Enabled"), 1.f);
+            setParameter(processor, getBandParameterID(band, "Freq"), freqs[band]);
+            setParameter(processor, getBandParameterID(band, "Gain"), band % 2 == 0 ? 3.f : -4.f);
+        }
+    }
+
+    //==============================================================================
+    // Runs one job per instance per cycle over numThreads threads, the calling one
+    // included. The workers spin briefly between cycles and then yield, much as a host's
+    // audio workers wait for the next graph cycle.
+    class GraphPool
+    {
+    public:
+        GraphPool(int numThreads, int numJobsPerCycle, std::function<void(int)> jobToRun)
+            : numJobs(numJobsPerCycle), job(std::move(jobToRun))
+        {
+            for (int i = 1; i < numThreads; ++i)
+                workers.emplace_back([this] { workerLoop(); });
+        }
+
+        ~GraphPool()
+        {
+            quit = true;
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        void runCycle()
+        {
+            // jobsDone first: a worker still on its way out of the last cycle may already
+            // claim job 0 once nextJob is back at 0, and its increment must not be lost
+            jobsDone.store(0);
+            nextJob.store(0);
+            cycle.fetch_add(1, std::memory_order_release);
+
+            runJobs();
+
+            while (jobsDone.load(std::memory_order_acquire) < numJobs)
+                std::this_thread::yield();
+        }
+
+    private:
+        void runJobs()
+        {
+            for (auto index = nextJob.fetch_add(1); index < numJobs; index = nextJob.fetch_add(1))
+            {
+                job(index);
+                jobsDone.fetch_add(1, std::memory_order_acq_rel);
+            }
+        }
+
+        void workerLoop()
+        {
+            auto seenCycle = cycle.load(std::memory_order_acquire);
+            while (! quit)
+            {
+                for (int spins = 0; cycle.load(std::memory_order_acquire) == seenCycle && ! quit; ++spins)
+                    if (spins > 1000)
+                        std::this_thread::yield();
+
+                seenCycle = cycle.load(std::memory_order_acquire);
+                runJobs();
+            }
+        }
+
+        const int numJobs;
+        const std::function<void(int)> job;
+        std::vector<std::thread> workers;
+        std::atomic<int> cycle { 0 }, nextJob { 0 }, jobsDone { 0 };
+        std::atomic<bool> quit { false };
+    };
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // Every processor starts a timer that picks up mode changes on the message thread, so a
+    // message manager has to exist. Nothing here dispatches it; the settings are all in
+    // place before prepareToPlay(), which applies them itself.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ArgumentList args(argc, argv);
+    const auto getInt = [&args](const char* option, int defaultValue)
+    {
+        return args.containsOption(option) ? args.removeValueForOption(option).getIntValue() : defaultValue;
+    };
+
+    const auto numInstances = getInt("--instances", 256);
+    const auto maxThreads = getInt("--threads", juce::SystemStats::getNumCpus());
+    const auto seconds = getInt("--seconds", 3);
+    const auto blockSize = getInt("--block", 128);
+    const auto numChannels = getInt("--channels", 2);
+    const auto linearPhase = args.removeOptionIfFound("--linear-phase");
+    const auto parallelChannels = args.removeOptionIfFound("--parallel-channels");
+    const auto outputFile = args.removeValueForOption("--output");
+
+    if (args.size() != 0 || numInstances < 1 || maxThreads < 1 || seconds < 1 || blockSize < 1
+        || numChannels < 1 || numChannels > 64)
+    {
+        std::cerr << "usage: " << args.executableName << " [--instances <n>] [--threads <n>] [--seconds <n>]"
+                  << " [--block <n>] [--channels <n>] [--linear-phase] [--parallel-channels] [--output <file>]" << std::endl;
+        return 1;
+    }
+
+    // Whatever JUCE and the shared threads and tables set up once per process shouldn't be
+    // charged to the first instance of the measured batch. The shared ones only live as
+    // long as some instance does, so this one stays around.
+    First_EQAudioProcessor warmUp;
+    warmUp.prepareToPlay(sampleRate, blockSize);
+
+    std::vector<std::unique_ptr<First_EQAudioProcessor>> processors;
+    processors.reserve((size_t) numInstances);
+
+    const auto empty = Footprint::now();
+    auto start = juce::Time::getHighResolutionTicks();
+    for (int i = 0; i < numInstances; ++i)
+        processors.push_back(std::make_unique<First_EQAudioProcessor>());
+    const auto constructSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    const auto constructed = Footprint::now();
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+
+    start = juce::Time::getHighResolutionTicks();
+    for (auto& processor : processors)
+    {
+        setUpInstance(*processor, linearPhase, parallelChannels);
+        processor->setBusesLayout(layout);
+        processor->prepareToPlay(sampleRate, blockSize);
+    }
+    const auto prepareSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+    const auto prepared = Footprint::now();
+
+    // Let the designer threads publish the settings before anything is timed
+    juce::Thread::sleep(200);
+
+    std::cout << numInstances << " instances, " << numChannels << " channels, block " << blockSize
+              << (linearPhase ? ", linear phase" : "") << (parallelChannels ? ", parallel channels" : "") << std::endl
+              << "construct: " << (constructed.heapBytes - empty.heapBytes) / numInstances << " heap bytes, "
+              << constructSeconds * 1.0e6 / numInstances << " us per instance" << std::endl
+              << "prepare:   " << (prepared.heapBytes - constructed.heapBytes) / numInstances << " heap bytes, "
+              << prepareSeconds * 1.0e6 / numInstances << " us per instance" << std::endl;
+    if (empty.residentBytes >= 0)
+        std::cout << "resident:  " << (prepared.residentBytes - empty.residentBytes) / numInstances
+                  << " bytes per instance" << std::endl;
+
+    // Every instance has the same settings, so all but the first should find theirs here
+    const auto cacheStatistics = CoefficientCache::getInstance().getStatistics();
+    std::cout << "coefficient cache: " << cacheStatistics.hits << " hits, " << cacheStatistics.misses
+              << " misses" << std::endl;
+
+    // Noise to refill every block with, and a buffer per instance to process in place
+    juce::AudioBuffer<float> noise(numChannels, blockSize);
+    juce::Random random(1);
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            noise.setSample(ch, i, random.nextFloat() * 0.5f - 0.25f);
+
+    std::vector<juce::AudioBuffer<float>> buffers((size_t) numInstances, juce::AudioBuffer<float>(numChannels, blockSize));
+    std::vector<juce::MidiBuffer> midiBuffers((size_t) numInstances);
+
+    const auto processInstance = [&](int index)
+    {
+        auto& buffer = buffers[(size_t) index];
+        for (int ch = 0; ch < numChannels; ++ch)
+            buffer.copyFrom(ch, 0, noise, ch, 0, blockSize);
+        processors[(size_t) index]->processBlock(buffer, midiBuffers[(size_t) index]);
+    };
+
+    const auto blockSeconds = blockSize / sampleRate;
+    juce::Array<juce::var> scaling;
+    double singleThreadThroughput = 0;
+
+    for (int numThreads = 1;; numThreads = juce::jmin(2 * numThreads, maxThreads))
+    {
+        GraphPool pool(numThreads, numInstances, processInstance);
+        pool.runCycle();
+
+        int numCycles = 0, lateCycles = 0;
+        const auto runStart = juce::Time::getHighResolutionTicks();
+        double elapsed = 0;
+
+        while (elapsed < seconds)
+        {
+            const auto cycleStart = juce::Time::getHighResolutionTicks();
+            pool.runCycle();
+            const auto cycleEnd = juce::Time::getHighResolutionTicks();
+
+            ++numCycles;
+            if (juce::Time::highResolutionTicksToSeconds(cycleEnd - cycleStart) > blockSeconds)
+                ++lateCycles;
+            elapsed = juce::Time::highResolutionTicksToSeconds(cycleEnd - runStart);
+        }
+
+        // Instance-seconds of audio per second of wall time
+        const auto throughput = numInstances * numCycles * blockSeconds / elapsed;
+        if (numThreads == 1)
+            singleThreadThroughput = throughput;
+
+        std::cout << numThreads << " threads: " << numCycles << " cycles, " << lateCycles << " late, "
+                  << juce::String(throughput, 1) << " instances in real time, speed-up "
+                  << juce::String(throughput / singleThreadThroughput, 2) << std::endl;
+
+        auto* result = new juce::DynamicObject();
+        result->setProperty("threads", numThreads);
+        result->setProperty("cycles", numCycles);
+        result->setProperty("lateCycles", lateCycles);
+        result->setProperty("realtimeInstances", throughput);
+        result->setProperty("speedUp", throughput / singleThreadThroughput);
+        scaling.add(juce::var(result));
+
+        if (numThreads == maxThreads)
+            break;
+    }
+
+    if (outputFile.isNotEmpty())
+    {
+        auto* report = new juce::DynamicObject();
+        report->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+        report->setProperty("cpu", juce::SystemStats::getCpuModel());
+        report->setProperty("cores", juce::SystemStats::getNumPhysicalCpus());
+        report->setProperty("instances", numInstances);
+        report->setProperty("channels", numChannels);
+        report->setProperty("blockSize", blockSize);
+        report->setProperty("sampleRate", sampleRate);
+        report->setProperty("linearPhase", linearPhase);
+        report->setProperty("parallelChannels", parallelChannels);
+        report->setProperty("construct", describeGrowth(empty, constructed, constructSeconds, numInstances));
+        report->setProperty("prepare", describeGrowth(constructed, prepared, prepareSeconds, numInstances));
+        report->setProperty("cacheHits", (juce::int64) cacheStatistics.hits);
+        report->setProperty("cacheMisses", (juce::int64) cacheStatistics.misses);
+        report->setProperty("scaling", scaling);
+
+        if (! juce::File::getCurrentWorkingDirectory().getChildFile(outputFile).replaceWithText(juce::JSON::toString(juce::var(report))))
+        {
+            std::cerr << "cannot write " << outputFile << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}